@@ -5,6 +5,66 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
+
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+#define OTHELLO_NO_THREADS
+#endif
+
+#ifdef _WIN32
+#include <windows.h>
+#include <process.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef OTHELLO_NO_THREADS
+typedef int thread_t;
+#elif defined(_WIN32)
+typedef HANDLE thread_t;
+typedef CRITICAL_SECTION mutex_t;
+typedef CONDITION_VARIABLE cond_t;
+#else
+#include <pthread.h>
+typedef pthread_t thread_t;
+typedef pthread_mutex_t mutex_t;
+typedef pthread_cond_t cond_t;
+#endif
+
+#if defined(__GNUC__) && defined(__x86_64__) && !defined(OTHELLO_NO_SIMD)
+#define HAVE_X86_SIMD
+#include <immintrin.h>
+#endif
+
+#if defined(HAVE_X86_SIMD) && !defined(OTHELLO_KOGGE_STONE)
+#define HAVE_SIMD_MOVES
+#endif
+
+/* Data shared between search threads without a lock is read and written
+   with relaxed atomics where C11 atomics are available, or else through
+   volatile. */
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L && \
+    !defined(__STDC_NO_ATOMICS__)
+#include <stdatomic.h>
+#endif
+
+#ifdef ATOMIC_INT_LOCK_FREE
+#define ATOMIC(type) _Atomic type
+#define load_relaxed(p) atomic_load_explicit((p), memory_order_relaxed)
+#define store_relaxed(p, x) \
+        atomic_store_explicit((p), (x), memory_order_relaxed)
+#else
+#define ATOMIC(type) volatile type
+#define load_relaxed(p) (*(p))
+#define store_relaxed(p, x) ((void)(*(p) = (x)))
+#endif
+
+/* An othello_stop_t, which is a plain volatile int to its users, accessed
+   as an atomic one. */
+#define STOP_FLAG(p) ((volatile ATOMIC(int) *)(p))
 
 void othello_init(othello_t *o)
 {
@@ -66,6 +126,23 @@ static int popcount(uint64_t x)
 #endif
 }
 
+/* Index of the lowest set bit; x must be non-zero. */
+static int ctz(uint64_t x)
+{
+#ifdef __GNUC__
+        return __builtin_ctzll(x);
+#else
+        int n = 0;
+
+        while (!(x & 1)) {
+                x >>= 1;
+                n++;
+        }
+
+        return n;
+#endif
+}
+
 int othello_score(const othello_t *o, player_t p)
 {
         return popcount(o->disks[p]);
@@ -122,7 +199,7 @@ static uint64_t shift(uint64_t disks, int dir)
         }
 }
 
-static uint64_t generate_moves(uint64_t my_disks, uint64_t opp_disks)
+static uint64_t generate_moves_dumb7fill(uint64_t my_disks, uint64_t opp_disks)
 {
         int dir;
         uint64_t x;
@@ -149,6 +226,207 @@ static uint64_t generate_moves(uint64_t my_disks, uint64_t opp_disks)
         return legal_moves;
 }
 
+/* Moves in one direction, found by a Kogge-Stone fill: each step doubles
+   the shift, so runs of up to eight opponent disks take three steps. The
+   mask excludes cells the shift would wrap into. */
+static uint64_t kogge_stone_left(uint64_t my_disks, uint64_t opp_disks,
+                                 uint64_t empty_cells, int n, uint64_t mask)
+{
+        uint64_t pro = opp_disks & mask;
+        uint64_t x = pro & (my_disks << n);
+
+        x |= pro & (x << n);
+        pro &= pro << n;
+        x |= pro & (x << (2 * n));
+        pro &= pro << (2 * n);
+        x |= pro & (x << (4 * n));
+
+        return (x << n) & empty_cells & mask;
+}
+
+static uint64_t kogge_stone_right(uint64_t my_disks, uint64_t opp_disks,
+                                  uint64_t empty_cells, int n, uint64_t mask)
+{
+        uint64_t pro = opp_disks & mask;
+        uint64_t x = pro & (my_disks >> n);
+
+        x |= pro & (x >> n);
+        pro &= pro >> n;
+        x |= pro & (x >> (2 * n));
+        pro &= pro >> (2 * n);
+        x |= pro & (x >> (4 * n));
+
+        return (x >> n) & empty_cells & mask;
+}
+
+static uint64_t generate_moves_kogge_stone(uint64_t my_disks,
+                                           uint64_t opp_disks)
+{
+        static const uint64_t NOT_A = 0xFEFEFEFEFEFEFEFEULL;
+        static const uint64_t NOT_H = 0x7F7F7F7F7F7F7F7FULL;
+
+        uint64_t empty_cells = ~(my_disks | opp_disks);
+
+        assert((my_disks & opp_disks) == 0 && "Disk sets should be disjoint.");
+
+        return kogge_stone_left(my_disks, opp_disks, empty_cells, 1, NOT_A) |
+               kogge_stone_left(my_disks, opp_disks, empty_cells, 7, NOT_H) |
+               kogge_stone_left(my_disks, opp_disks, empty_cells, 8, ~0ULL) |
+               kogge_stone_left(my_disks, opp_disks, empty_cells, 9, NOT_A) |
+               kogge_stone_right(my_disks, opp_disks, empty_cells, 1, NOT_H) |
+               kogge_stone_right(my_disks, opp_disks, empty_cells, 7, NOT_A) |
+               kogge_stone_right(my_disks, opp_disks, empty_cells, 8, ~0ULL) |
+               kogge_stone_right(my_disks, opp_disks, empty_cells, 9, NOT_H);
+}
+
+#ifdef HAVE_SIMD_MOVES
+/* Move generation processing four directions per lane. */
+__attribute__((target("avx2")))
+static uint64_t generate_moves_avx2(uint64_t my_disks, uint64_t opp_disks)
+{
+        /* Up-right, up, up-left and left; shifting the other way gives
+           down-left, down, down-right and right. */
+        const __m256i SHIFTS = _mm256_set_epi64x(7, 8, 9, 1);
+        const __m256i LMASKS = _mm256_set_epi64x(
+                0x7F7F7F7F7F7F7F00ULL, 0xFFFFFFFFFFFFFFFFULL,
+                0xFEFEFEFEFEFEFE00ULL, 0xFEFEFEFEFEFEFEFEULL);
+        const __m256i RMASKS = _mm256_set_epi64x(
+                0x00FEFEFEFEFEFEFEULL, 0xFFFFFFFFFFFFFFFFULL,
+                0x007F7F7F7F7F7F7FULL, 0x7F7F7F7F7F7F7F7FULL);
+
+        __m256i my = _mm256_set1_epi64x((long long)my_disks);
+        __m256i opp = _mm256_set1_epi64x((long long)opp_disks);
+        __m256i empty = _mm256_set1_epi64x(
+                (long long)~(my_disks | opp_disks));
+        __m256i lopp = _mm256_and_si256(opp, LMASKS);
+        __m256i ropp = _mm256_and_si256(opp, RMASKS);
+        __m256i l, r;
+        __m128i x;
+        int i;
+
+        assert((my_disks & opp_disks) == 0 && "Disk sets should be disjoint.");
+
+        l = _mm256_and_si256(_mm256_sllv_epi64(my, SHIFTS), lopp);
+        r = _mm256_and_si256(_mm256_srlv_epi64(my, SHIFTS), ropp);
+        for (i = 0; i < 5; i++) {
+                l = _mm256_or_si256(l, _mm256_and_si256(
+                                _mm256_sllv_epi64(l, SHIFTS), lopp));
+                r = _mm256_or_si256(r, _mm256_and_si256(
+                                _mm256_srlv_epi64(r, SHIFTS), ropp));
+        }
+        l = _mm256_and_si256(_mm256_sllv_epi64(l, SHIFTS), LMASKS);
+        r = _mm256_and_si256(_mm256_srlv_epi64(r, SHIFTS), RMASKS);
+        l = _mm256_and_si256(_mm256_or_si256(l, r), empty);
+
+        x = _mm_or_si128(_mm256_castsi256_si128(l),
+                         _mm256_extracti128_si256(l, 1));
+
+        return (uint64_t)(_mm_cvtsi128_si64(x) |
+                          _mm_cvtsi128_si64(_mm_unpackhi_epi64(x, x)));
+}
+
+/* SSE2 lacks per-lane shift counts, so the second lane holds the board
+   flipped upside down: shifting both lanes left covers the upward
+   directions in the first lane and the downward ones in the second. The
+   horizontal directions are left to the portable code. */
+static uint64_t generate_moves_sse2(uint64_t my_disks, uint64_t opp_disks)
+{
+        const __m128i MASK7 = _mm_set1_epi64x(0x7F7F7F7F7F7F7F7FULL);
+        const __m128i MASK9 = _mm_set1_epi64x(0xFEFEFEFEFEFEFEFEULL);
+
+        uint64_t empty_cells = ~(my_disks | opp_disks);
+        uint64_t legal_moves, x;
+        __m128i my = _mm_set_epi64x((long long)__builtin_bswap64(my_disks),
+                                    (long long)my_disks);
+        __m128i opp = _mm_set_epi64x((long long)__builtin_bswap64(opp_disks),
+                                     (long long)opp_disks);
+        __m128i opp7 = _mm_and_si128(opp, MASK7);
+        __m128i opp9 = _mm_and_si128(opp, MASK9);
+        __m128i x7, x8, x9, moves;
+        int i, dir;
+
+        assert((my_disks & opp_disks) == 0 && "Disk sets should be disjoint.");
+
+        x7 = _mm_and_si128(_mm_slli_epi64(my, 7), opp7);
+        x8 = _mm_and_si128(_mm_slli_epi64(my, 8), opp);
+        x9 = _mm_and_si128(_mm_slli_epi64(my, 9), opp9);
+        for (i = 0; i < 5; i++) {
+                x7 = _mm_or_si128(x7, _mm_and_si128(_mm_slli_epi64(x7, 7),
+                                                    opp7));
+                x8 = _mm_or_si128(x8, _mm_and_si128(_mm_slli_epi64(x8, 8),
+                                                    opp));
+                x9 = _mm_or_si128(x9, _mm_and_si128(_mm_slli_epi64(x9, 9),
+                                                    opp9));
+        }
+        moves = _mm_or_si128(
+                _mm_and_si128(_mm_slli_epi64(x7, 7), MASK7),
+                _mm_or_si128(_mm_slli_epi64(x8, 8),
+                             _mm_and_si128(_mm_slli_epi64(x9, 9), MASK9)));
+
+        legal_moves = (uint64_t)_mm_cvtsi128_si64(moves);
+        legal_moves |= __builtin_bswap64((uint64_t)_mm_cvtsi128_si64(
+                                         _mm_unpackhi_epi64(moves, moves)));
+
+        for (dir = 0; dir < NUM_DIRS; dir += NUM_DIRS / 2) {
+                /* Right and left. */
+                x = shift(my_disks, dir) & opp_disks;
+                x |= shift(x, dir) & opp_disks;
+                x |= shift(x, dir) & opp_disks;
+                x |= shift(x, dir) & opp_disks;
+                x |= shift(x, dir) & opp_disks;
+                x |= shift(x, dir) & opp_disks;
+                legal_moves |= shift(x, dir);
+        }
+
+        return legal_moves & empty_cells;
+}
+#endif
+
+static uint64_t generate_moves(uint64_t my_disks, uint64_t opp_disks)
+{
+#ifdef HAVE_SIMD_MOVES
+        if (__builtin_cpu_supports("avx2")) {
+                return generate_moves_avx2(my_disks, opp_disks);
+        }
+        return generate_moves_sse2(my_disks, opp_disks);
+#elif defined(OTHELLO_KOGGE_STONE)
+        return generate_moves_kogge_stone(my_disks, opp_disks);
+#else
+        return generate_moves_dumb7fill(my_disks, opp_disks);
+#endif
+}
+
+bool othello_generate_moves(const othello_t *o, player_t p,
+                            othello_movegen_t impl, uint64_t *moves)
+{
+        uint64_t my_disks = o->disks[p], opp_disks = o->disks[p ^ 1];
+
+        switch (impl) {
+        case OTHELLO_MOVEGEN_DEFAULT:
+                *moves = generate_moves(my_disks, opp_disks);
+                return true;
+        case OTHELLO_MOVEGEN_DUMB7FILL:
+                *moves = generate_moves_dumb7fill(my_disks, opp_disks);
+                return true;
+        case OTHELLO_MOVEGEN_KOGGE_STONE:
+                *moves = generate_moves_kogge_stone(my_disks, opp_disks);
+                return true;
+#ifdef HAVE_SIMD_MOVES
+        case OTHELLO_MOVEGEN_SSE2:
+                *moves = generate_moves_sse2(my_disks, opp_disks);
+                return true;
+        case OTHELLO_MOVEGEN_AVX2:
+                if (!__builtin_cpu_supports("avx2")) {
+                        return false;
+                }
+                *moves = generate_moves_avx2(my_disks, opp_disks);
+                return true;
+#endif
+        default:
+                return false;
+        }
+}
+
 bool othello_has_valid_move(const othello_t *o, player_t p)
 {
         return generate_moves(o->disks[p], o->disks[p ^ 1]) != 0;
@@ -164,37 +442,618 @@ bool othello_is_valid_move(const othello_t *o, player_t p, int row, int col)
         return (generate_moves(o->disks[p], o->disks[p ^ 1]) & mask) != 0;
 }
 
+/* Line-indexed flip tables. A row, column or diagonal through the new disk
+   is gathered into eight bits, indexed by column (or by row for columns).
+   OUTFLANK[p][o] gives the cells that would bound a run of opponent disks o
+   starting next to position p, and FLIPPED[p][f] the disks between p and
+   the bounding disks f that are actually mine. */
+static const uint8_t OUTFLANK[8][256] = {
+        {
+                0x00, 0x00, 0x04, 0x04, 0x00, 0x00, 0x08, 0x08, 0x00, 0x00,
+                0x04, 0x04, 0x00, 0x00, 0x10, 0x10, 0x00, 0x00, 0x04, 0x04,
+                0x00, 0x00, 0x08, 0x08, 0x00, 0x00, 0x04, 0x04, 0x00, 0x00,
+                0x20, 0x20, 0x00, 0x00, 0x04, 0x04, 0x00, 0x00, 0x08, 0x08,
+                0x00, 0x00, 0x04, 0x04, 0x00, 0x00, 0x10, 0x10, 0x00, 0x00,
+                0x04, 0x04, 0x00, 0x00, 0x08, 0x08, 0x00, 0x00, 0x04, 0x04,
+                0x00, 0x00, 0x40, 0x40, 0x00, 0x00, 0x04, 0x04, 0x00, 0x00,
+                0x08, 0x08, 0x00, 0x00, 0x04, 0x04, 0x00, 0x00, 0x10, 0x10,
+                0x00, 0x00, 0x04, 0x04, 0x00, 0x00, 0x08, 0x08, 0x00, 0x00,
+                0x04, 0x04, 0x00, 0x00, 0x20, 0x20, 0x00, 0x00, 0x04, 0x04,
+                0x00, 0x00, 0x08, 0x08, 0x00, 0x00, 0x04, 0x04, 0x00, 0x00,
+                0x10, 0x10, 0x00, 0x00, 0x04, 0x04, 0x00, 0x00, 0x08, 0x08,
+                0x00, 0x00, 0x04, 0x04, 0x00, 0x00, 0x80, 0x80, 0x00, 0x00,
+                0x04, 0x04, 0x00, 0x00, 0x08, 0x08, 0x00, 0x00, 0x04, 0x04,
+                0x00, 0x00, 0x10, 0x10, 0x00, 0x00, 0x04, 0x04, 0x00, 0x00,
+                0x08, 0x08, 0x00, 0x00, 0x04, 0x04, 0x00, 0x00, 0x20, 0x20,
+                0x00, 0x00, 0x04, 0x04, 0x00, 0x00, 0x08, 0x08, 0x00, 0x00,
+                0x04, 0x04, 0x00, 0x00, 0x10, 0x10, 0x00, 0x00, 0x04, 0x04,
+                0x00, 0x00, 0x08, 0x08, 0x00, 0x00, 0x04, 0x04, 0x00, 0x00,
+                0x40, 0x40, 0x00, 0x00, 0x04, 0x04, 0x00, 0x00, 0x08, 0x08,
+                0x00, 0x00, 0x04, 0x04, 0x00, 0x00, 0x10, 0x10, 0x00, 0x00,
+                0x04, 0x04, 0x00, 0x00, 0x08, 0x08, 0x00, 0x00, 0x04, 0x04,
+                0x00, 0x00, 0x20, 0x20, 0x00, 0x00, 0x04, 0x04, 0x00, 0x00,
+                0x08, 0x08, 0x00, 0x00, 0x04, 0x04, 0x00, 0x00, 0x10, 0x10,
+                0x00, 0x00, 0x04, 0x04, 0x00, 0x00, 0x08, 0x08, 0x00, 0x00,
+                0x04, 0x04, 0x00, 0x00, 0x00, 0x00
+        },
+        {
+                0x00, 0x00, 0x00, 0x00, 0x08, 0x08, 0x08, 0x08, 0x00, 0x00,
+                0x00, 0x00, 0x10, 0x10, 0x10, 0x10, 0x00, 0x00, 0x00, 0x00,
+                0x08, 0x08, 0x08, 0x08, 0x00, 0x00, 0x00, 0x00, 0x20, 0x20,
+                0x20, 0x20, 0x00, 0x00, 0x00, 0x00, 0x08, 0x08, 0x08, 0x08,
+                0x00, 0x00, 0x00, 0x00, 0x10, 0x10, 0x10, 0x10, 0x00, 0x00,
+                0x00, 0x00, 0x08, 0x08, 0x08, 0x08, 0x00, 0x00, 0x00, 0x00,
+                0x40, 0x40, 0x40, 0x40, 0x00, 0x00, 0x00, 0x00, 0x08, 0x08,
+                0x08, 0x08, 0x00, 0x00, 0x00, 0x00, 0x10, 0x10, 0x10, 0x10,
+                0x00, 0x00, 0x00, 0x00, 0x08, 0x08, 0x08, 0x08, 0x00, 0x00,
+                0x00, 0x00, 0x20, 0x20, 0x20, 0x20, 0x00, 0x00, 0x00, 0x00,
+                0x08, 0x08, 0x08, 0x08, 0x00, 0x00, 0x00, 0x00, 0x10, 0x10,
+                0x10, 0x10, 0x00, 0x00, 0x00, 0x00, 0x08, 0x08, 0x08, 0x08,
+                0x00, 0x00, 0x00, 0x00, 0x80, 0x80, 0x80, 0x80, 0x00, 0x00,
+                0x00, 0x00, 0x08, 0x08, 0x08, 0x08, 0x00, 0x00, 0x00, 0x00,
+                0x10, 0x10, 0x10, 0x10, 0x00, 0x00, 0x00, 0x00, 0x08, 0x08,
+                0x08, 0x08, 0x00, 0x00, 0x00, 0x00, 0x20, 0x20, 0x20, 0x20,
+                0x00, 0x00, 0x00, 0x00, 0x08, 0x08, 0x08, 0x08, 0x00, 0x00,
+                0x00, 0x00, 0x10, 0x10, 0x10, 0x10, 0x00, 0x00, 0x00, 0x00,
+                0x08, 0x08, 0x08, 0x08, 0x00, 0x00, 0x00, 0x00, 0x40, 0x40,
+                0x40, 0x40, 0x00, 0x00, 0x00, 0x00, 0x08, 0x08, 0x08, 0x08,
+                0x00, 0x00, 0x00, 0x00, 0x10, 0x10, 0x10, 0x10, 0x00, 0x00,
+                0x00, 0x00, 0x08, 0x08, 0x08, 0x08, 0x00, 0x00, 0x00, 0x00,
+                0x20, 0x20, 0x20, 0x20, 0x00, 0x00, 0x00, 0x00, 0x08, 0x08,
+                0x08, 0x08, 0x00, 0x00, 0x00, 0x00, 0x10, 0x10, 0x10, 0x10,
+                0x00, 0x00, 0x00, 0x00, 0x08, 0x08, 0x08, 0x08, 0x00, 0x00,
+                0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+        },
+        {
+                0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x10, 0x10,
+                0x11, 0x10, 0x10, 0x10, 0x11, 0x10, 0x00, 0x00, 0x01, 0x00,
+                0x00, 0x00, 0x01, 0x00, 0x20, 0x20, 0x21, 0x20, 0x20, 0x20,
+                0x21, 0x20, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x00,
+                0x10, 0x10, 0x11, 0x10, 0x10, 0x10, 0x11, 0x10, 0x00, 0x00,
+                0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x40, 0x40, 0x41, 0x40,
+                0x40, 0x40, 0x41, 0x40, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
+                0x01, 0x00, 0x10, 0x10, 0x11, 0x10, 0x10, 0x10, 0x11, 0x10,
+                0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x20, 0x20,
+                0x21, 0x20, 0x20, 0x20, 0x21, 0x20, 0x00, 0x00, 0x01, 0x00,
+                0x00, 0x00, 0x01, 0x00, 0x10, 0x10, 0x11, 0x10, 0x10, 0x10,
+                0x11, 0x10, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x00,
+                0x80, 0x80, 0x81, 0x80, 0x80, 0x80, 0x81, 0x80, 0x00, 0x00,
+                0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x10, 0x10, 0x11, 0x10,
+                0x10, 0x10, 0x11, 0x10, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
+                0x01, 0x00, 0x20, 0x20, 0x21, 0x20, 0x20, 0x20, 0x21, 0x20,
+                0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x10, 0x10,
+                0x11, 0x10, 0x10, 0x10, 0x11, 0x10, 0x00, 0x00, 0x01, 0x00,
+                0x00, 0x00, 0x01, 0x00, 0x40, 0x40, 0x41, 0x40, 0x40, 0x40,
+                0x41, 0x40, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x00,
+                0x10, 0x10, 0x11, 0x10, 0x10, 0x10, 0x11, 0x10, 0x00, 0x00,
+                0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x20, 0x20, 0x21, 0x20,
+                0x20, 0x20, 0x21, 0x20, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
+                0x01, 0x00, 0x10, 0x10, 0x11, 0x10, 0x10, 0x10, 0x11, 0x10,
+                0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
+                0x01, 0x00, 0x00, 0x00, 0x01, 0x00
+        },
+        {
+                0x00, 0x00, 0x00, 0x00, 0x02, 0x02, 0x01, 0x00, 0x00, 0x00,
+                0x00, 0x00, 0x02, 0x02, 0x01, 0x00, 0x20, 0x20, 0x20, 0x20,
+                0x22, 0x22, 0x21, 0x20, 0x20, 0x20, 0x20, 0x20, 0x22, 0x22,
+                0x21, 0x20, 0x00, 0x00, 0x00, 0x00, 0x02, 0x02, 0x01, 0x00,
+                0x00, 0x00, 0x00, 0x00, 0x02, 0x02, 0x01, 0x00, 0x40, 0x40,
+                0x40, 0x40, 0x42, 0x42, 0x41, 0x40, 0x40, 0x40, 0x40, 0x40,
+                0x42, 0x42, 0x41, 0x40, 0x00, 0x00, 0x00, 0x00, 0x02, 0x02,
+                0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x02, 0x01, 0x00,
+                0x20, 0x20, 0x20, 0x20, 0x22, 0x22, 0x21, 0x20, 0x20, 0x20,
+                0x20, 0x20, 0x22, 0x22, 0x21, 0x20, 0x00, 0x00, 0x00, 0x00,
+                0x02, 0x02, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x02,
+                0x01, 0x00, 0x80, 0x80, 0x80, 0x80, 0x82, 0x82, 0x81, 0x80,
+                0x80, 0x80, 0x80, 0x80, 0x82, 0x82, 0x81, 0x80, 0x00, 0x00,
+                0x00, 0x00, 0x02, 0x02, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00,
+                0x02, 0x02, 0x01, 0x00, 0x20, 0x20, 0x20, 0x20, 0x22, 0x22,
+                0x21, 0x20, 0x20, 0x20, 0x20, 0x20, 0x22, 0x22, 0x21, 0x20,
+                0x00, 0x00, 0x00, 0x00, 0x02, 0x02, 0x01, 0x00, 0x00, 0x00,
+                0x00, 0x00, 0x02, 0x02, 0x01, 0x00, 0x40, 0x40, 0x40, 0x40,
+                0x42, 0x42, 0x41, 0x40, 0x40, 0x40, 0x40, 0x40, 0x42, 0x42,
+                0x41, 0x40, 0x00, 0x00, 0x00, 0x00, 0x02, 0x02, 0x01, 0x00,
+                0x00, 0x00, 0x00, 0x00, 0x02, 0x02, 0x01, 0x00, 0x20, 0x20,
+                0x20, 0x20, 0x22, 0x22, 0x21, 0x20, 0x20, 0x20, 0x20, 0x20,
+                0x22, 0x22, 0x21, 0x20, 0x00, 0x00, 0x00, 0x00, 0x02, 0x02,
+                0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x02, 0x01, 0x00,
+                0x00, 0x00, 0x00, 0x00, 0x02, 0x02, 0x01, 0x00, 0x00, 0x00,
+                0x00, 0x00, 0x02, 0x02, 0x01, 0x00
+        },
+        {
+                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x04,
+                0x04, 0x04, 0x02, 0x02, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00,
+                0x00, 0x00, 0x00, 0x00, 0x04, 0x04, 0x04, 0x04, 0x02, 0x02,
+                0x01, 0x00, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40,
+                0x44, 0x44, 0x44, 0x44, 0x42, 0x42, 0x41, 0x40, 0x40, 0x40,
+                0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x44, 0x44, 0x44, 0x44,
+                0x42, 0x42, 0x41, 0x40, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                0x00, 0x00, 0x04, 0x04, 0x04, 0x04, 0x02, 0x02, 0x01, 0x00,
+                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x04,
+                0x04, 0x04, 0x02, 0x02, 0x01, 0x00, 0x80, 0x80, 0x80, 0x80,
+                0x80, 0x80, 0x80, 0x80, 0x84, 0x84, 0x84, 0x84, 0x82, 0x82,
+                0x81, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+                0x84, 0x84, 0x84, 0x84, 0x82, 0x82, 0x81, 0x80, 0x00, 0x00,
+                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x04, 0x04, 0x04,
+                0x02, 0x02, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                0x00, 0x00, 0x04, 0x04, 0x04, 0x04, 0x02, 0x02, 0x01, 0x00,
+                0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x44, 0x44,
+                0x44, 0x44, 0x42, 0x42, 0x41, 0x40, 0x40, 0x40, 0x40, 0x40,
+                0x40, 0x40, 0x40, 0x40, 0x44, 0x44, 0x44, 0x44, 0x42, 0x42,
+                0x41, 0x40, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                0x04, 0x04, 0x04, 0x04, 0x02, 0x02, 0x01, 0x00, 0x00, 0x00,
+                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x04, 0x04, 0x04,
+                0x02, 0x02, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                0x00, 0x00, 0x04, 0x04, 0x04, 0x04, 0x02, 0x02, 0x01, 0x00,
+                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x04,
+                0x04, 0x04, 0x02, 0x02, 0x01, 0x00
+        },
+        {
+                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x08, 0x08, 0x08, 0x08,
+                0x08, 0x08, 0x08, 0x08, 0x04, 0x04, 0x04, 0x04, 0x02, 0x02,
+                0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x08, 0x08,
+                0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x04, 0x04, 0x04, 0x04,
+                0x02, 0x02, 0x01, 0x00, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+                0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+                0x88, 0x88, 0x88, 0x88, 0x88, 0x88, 0x88, 0x88, 0x84, 0x84,
+                0x84, 0x84, 0x82, 0x82, 0x81, 0x80, 0x80, 0x80, 0x80, 0x80,
+                0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+                0x80, 0x80, 0x88, 0x88, 0x88, 0x88, 0x88, 0x88, 0x88, 0x88,
+                0x84, 0x84, 0x84, 0x84, 0x82, 0x82, 0x81, 0x80, 0x00, 0x00,
+                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                0x00, 0x00, 0x00, 0x00, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08,
+                0x08, 0x08, 0x04, 0x04, 0x04, 0x04, 0x02, 0x02, 0x01, 0x00,
+                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x08, 0x08, 0x08, 0x08,
+                0x08, 0x08, 0x08, 0x08, 0x04, 0x04, 0x04, 0x04, 0x02, 0x02,
+                0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x08, 0x08,
+                0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x04, 0x04, 0x04, 0x04,
+                0x02, 0x02, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x04, 0x04,
+                0x04, 0x04, 0x02, 0x02, 0x01, 0x00
+        },
+        {
+                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                0x00, 0x00, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+                0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x08, 0x08,
+                0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x04, 0x04, 0x04, 0x04,
+                0x02, 0x02, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x10, 0x10, 0x10,
+                0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+                0x10, 0x10, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08,
+                0x04, 0x04, 0x04, 0x04, 0x02, 0x02, 0x01, 0x00, 0x00, 0x00,
+                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+                0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x08, 0x08, 0x08, 0x08,
+                0x08, 0x08, 0x08, 0x08, 0x04, 0x04, 0x04, 0x04, 0x02, 0x02,
+                0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                0x00, 0x00, 0x00, 0x00, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+                0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+                0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x04, 0x04,
+                0x04, 0x04, 0x02, 0x02, 0x01, 0x00
+        },
+        {
+                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                0x00, 0x00, 0x00, 0x00, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+                0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+                0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+                0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x10, 0x10, 0x10, 0x10,
+                0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+                0x10, 0x10, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08,
+                0x04, 0x04, 0x04, 0x04, 0x02, 0x02, 0x01, 0x00, 0x00, 0x00,
+                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                0x00, 0x00, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+                0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+                0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+                0x20, 0x20, 0x20, 0x20, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+                0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+                0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x04, 0x04,
+                0x04, 0x04, 0x02, 0x02, 0x01, 0x00
+        }
+};
+
+static const uint8_t FLIPPED[8][256] = {
+        {
+                0x00, 0x00, 0x00, 0x00, 0x02, 0x02, 0x02, 0x02, 0x06, 0x06,
+                0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x0E, 0x0E, 0x0E, 0x0E,
+                0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E, 0x0E,
+                0x0E, 0x0E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E,
+                0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E,
+                0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E,
+                0x1E, 0x1E, 0x1E, 0x1E, 0x3E, 0x3E, 0x3E, 0x3E, 0x3E, 0x3E,
+                0x3E, 0x3E, 0x3E, 0x3E, 0x3E, 0x3E, 0x3E, 0x3E, 0x3E, 0x3E,
+                0x3E, 0x3E, 0x3E, 0x3E, 0x3E, 0x3E, 0x3E, 0x3E, 0x3E, 0x3E,
+                0x3E, 0x3E, 0x3E, 0x3E, 0x3E, 0x3E, 0x3E, 0x3E, 0x3E, 0x3E,
+                0x3E, 0x3E, 0x3E, 0x3E, 0x3E, 0x3E, 0x3E, 0x3E, 0x3E, 0x3E,
+                0x3E, 0x3E, 0x3E, 0x3E, 0x3E, 0x3E, 0x3E, 0x3E, 0x3E, 0x3E,
+                0x3E, 0x3E, 0x3E, 0x3E, 0x3E, 0x3E, 0x3E, 0x3E, 0x7E, 0x7E,
+                0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E,
+                0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E,
+                0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E,
+                0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E,
+                0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E,
+                0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E,
+                0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E,
+                0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E,
+                0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E,
+                0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E,
+                0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E,
+                0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E,
+                0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E
+        },
+        {
+                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x04,
+                0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0C, 0x0C, 0x0C, 0x0C,
+                0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C,
+                0x0C, 0x0C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C,
+                0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C,
+                0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C,
+                0x1C, 0x1C, 0x1C, 0x1C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C,
+                0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C,
+                0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C,
+                0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C,
+                0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C,
+                0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C,
+                0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x3C, 0x7C, 0x7C,
+                0x7C, 0x7C, 0x7C, 0x7C, 0x7C, 0x7C, 0x7C, 0x7C, 0x7C, 0x7C,
+                0x7C, 0x7C, 0x7C, 0x7C, 0x7C, 0x7C, 0x7C, 0x7C, 0x7C, 0x7C,
+                0x7C, 0x7C, 0x7C, 0x7C, 0x7C, 0x7C, 0x7C, 0x7C, 0x7C, 0x7C,
+                0x7C, 0x7C, 0x7C, 0x7C, 0x7C, 0x7C, 0x7C, 0x7C, 0x7C, 0x7C,
+                0x7C, 0x7C, 0x7C, 0x7C, 0x7C, 0x7C, 0x7C, 0x7C, 0x7C, 0x7C,
+                0x7C, 0x7C, 0x7C, 0x7C, 0x7C, 0x7C, 0x7C, 0x7C, 0x7C, 0x7C,
+                0x7C, 0x7C, 0x7C, 0x7C, 0x7C, 0x7C, 0x7C, 0x7C, 0x7C, 0x7C,
+                0x7C, 0x7C, 0x7C, 0x7C, 0x7C, 0x7C, 0x7C, 0x7C, 0x7C, 0x7C,
+                0x7C, 0x7C, 0x7C, 0x7C, 0x7C, 0x7C, 0x7C, 0x7C, 0x7C, 0x7C,
+                0x7C, 0x7C, 0x7C, 0x7C, 0x7C, 0x7C, 0x7C, 0x7C, 0x7C, 0x7C,
+                0x7C, 0x7C, 0x7C, 0x7C, 0x7C, 0x7C, 0x7C, 0x7C, 0x7C, 0x7C,
+                0x7C, 0x7C, 0x7C, 0x7C, 0x7C, 0x7C, 0x7C, 0x7C, 0x7C, 0x7C,
+                0x7C, 0x7C, 0x7C, 0x7C, 0x7C, 0x7C
+        },
+        {
+                0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02,
+                0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x08, 0x0A, 0x08, 0x0A,
+                0x08, 0x0A, 0x08, 0x0A, 0x08, 0x0A, 0x08, 0x0A, 0x08, 0x0A,
+                0x08, 0x0A, 0x18, 0x1A, 0x18, 0x1A, 0x18, 0x1A, 0x18, 0x1A,
+                0x18, 0x1A, 0x18, 0x1A, 0x18, 0x1A, 0x18, 0x1A, 0x18, 0x1A,
+                0x18, 0x1A, 0x18, 0x1A, 0x18, 0x1A, 0x18, 0x1A, 0x18, 0x1A,
+                0x18, 0x1A, 0x18, 0x1A, 0x38, 0x3A, 0x38, 0x3A, 0x38, 0x3A,
+                0x38, 0x3A, 0x38, 0x3A, 0x38, 0x3A, 0x38, 0x3A, 0x38, 0x3A,
+                0x38, 0x3A, 0x38, 0x3A, 0x38, 0x3A, 0x38, 0x3A, 0x38, 0x3A,
+                0x38, 0x3A, 0x38, 0x3A, 0x38, 0x3A, 0x38, 0x3A, 0x38, 0x3A,
+                0x38, 0x3A, 0x38, 0x3A, 0x38, 0x3A, 0x38, 0x3A, 0x38, 0x3A,
+                0x38, 0x3A, 0x38, 0x3A, 0x38, 0x3A, 0x38, 0x3A, 0x38, 0x3A,
+                0x38, 0x3A, 0x38, 0x3A, 0x38, 0x3A, 0x38, 0x3A, 0x78, 0x7A,
+                0x78, 0x7A, 0x78, 0x7A, 0x78, 0x7A, 0x78, 0x7A, 0x78, 0x7A,
+                0x78, 0x7A, 0x78, 0x7A, 0x78, 0x7A, 0x78, 0x7A, 0x78, 0x7A,
+                0x78, 0x7A, 0x78, 0x7A, 0x78, 0x7A, 0x78, 0x7A, 0x78, 0x7A,
+                0x78, 0x7A, 0x78, 0x7A, 0x78, 0x7A, 0x78, 0x7A, 0x78, 0x7A,
+                0x78, 0x7A, 0x78, 0x7A, 0x78, 0x7A, 0x78, 0x7A, 0x78, 0x7A,
+                0x78, 0x7A, 0x78, 0x7A, 0x78, 0x7A, 0x78, 0x7A, 0x78, 0x7A,
+                0x78, 0x7A, 0x78, 0x7A, 0x78, 0x7A, 0x78, 0x7A, 0x78, 0x7A,
+                0x78, 0x7A, 0x78, 0x7A, 0x78, 0x7A, 0x78, 0x7A, 0x78, 0x7A,
+                0x78, 0x7A, 0x78, 0x7A, 0x78, 0x7A, 0x78, 0x7A, 0x78, 0x7A,
+                0x78, 0x7A, 0x78, 0x7A, 0x78, 0x7A, 0x78, 0x7A, 0x78, 0x7A,
+                0x78, 0x7A, 0x78, 0x7A, 0x78, 0x7A, 0x78, 0x7A, 0x78, 0x7A,
+                0x78, 0x7A, 0x78, 0x7A, 0x78, 0x7A, 0x78, 0x7A, 0x78, 0x7A,
+                0x78, 0x7A, 0x78, 0x7A, 0x78, 0x7A
+        },
+        {
+                0x00, 0x06, 0x04, 0x06, 0x00, 0x06, 0x04, 0x06, 0x00, 0x06,
+                0x04, 0x06, 0x00, 0x06, 0x04, 0x06, 0x00, 0x06, 0x04, 0x06,
+                0x00, 0x06, 0x04, 0x06, 0x00, 0x06, 0x04, 0x06, 0x00, 0x06,
+                0x04, 0x06, 0x10, 0x16, 0x14, 0x16, 0x10, 0x16, 0x14, 0x16,
+                0x10, 0x16, 0x14, 0x16, 0x10, 0x16, 0x14, 0x16, 0x10, 0x16,
+                0x14, 0x16, 0x10, 0x16, 0x14, 0x16, 0x10, 0x16, 0x14, 0x16,
+                0x10, 0x16, 0x14, 0x16, 0x30, 0x36, 0x34, 0x36, 0x30, 0x36,
+                0x34, 0x36, 0x30, 0x36, 0x34, 0x36, 0x30, 0x36, 0x34, 0x36,
+                0x30, 0x36, 0x34, 0x36, 0x30, 0x36, 0x34, 0x36, 0x30, 0x36,
+                0x34, 0x36, 0x30, 0x36, 0x34, 0x36, 0x30, 0x36, 0x34, 0x36,
+                0x30, 0x36, 0x34, 0x36, 0x30, 0x36, 0x34, 0x36, 0x30, 0x36,
+                0x34, 0x36, 0x30, 0x36, 0x34, 0x36, 0x30, 0x36, 0x34, 0x36,
+                0x30, 0x36, 0x34, 0x36, 0x30, 0x36, 0x34, 0x36, 0x70, 0x76,
+                0x74, 0x76, 0x70, 0x76, 0x74, 0x76, 0x70, 0x76, 0x74, 0x76,
+                0x70, 0x76, 0x74, 0x76, 0x70, 0x76, 0x74, 0x76, 0x70, 0x76,
+                0x74, 0x76, 0x70, 0x76, 0x74, 0x76, 0x70, 0x76, 0x74, 0x76,
+                0x70, 0x76, 0x74, 0x76, 0x70, 0x76, 0x74, 0x76, 0x70, 0x76,
+                0x74, 0x76, 0x70, 0x76, 0x74, 0x76, 0x70, 0x76, 0x74, 0x76,
+                0x70, 0x76, 0x74, 0x76, 0x70, 0x76, 0x74, 0x76, 0x70, 0x76,
+                0x74, 0x76, 0x70, 0x76, 0x74, 0x76, 0x70, 0x76, 0x74, 0x76,
+                0x70, 0x76, 0x74, 0x76, 0x70, 0x76, 0x74, 0x76, 0x70, 0x76,
+                0x74, 0x76, 0x70, 0x76, 0x74, 0x76, 0x70, 0x76, 0x74, 0x76,
+                0x70, 0x76, 0x74, 0x76, 0x70, 0x76, 0x74, 0x76, 0x70, 0x76,
+                0x74, 0x76, 0x70, 0x76, 0x74, 0x76, 0x70, 0x76, 0x74, 0x76,
+                0x70, 0x76, 0x74, 0x76, 0x70, 0x76, 0x74, 0x76, 0x70, 0x76,
+                0x74, 0x76, 0x70, 0x76, 0x74, 0x76
+        },
+        {
+                0x00, 0x0E, 0x0C, 0x0E, 0x08, 0x0E, 0x0C, 0x0E, 0x00, 0x0E,
+                0x0C, 0x0E, 0x08, 0x0E, 0x0C, 0x0E, 0x00, 0x0E, 0x0C, 0x0E,
+                0x08, 0x0E, 0x0C, 0x0E, 0x00, 0x0E, 0x0C, 0x0E, 0x08, 0x0E,
+                0x0C, 0x0E, 0x00, 0x0E, 0x0C, 0x0E, 0x08, 0x0E, 0x0C, 0x0E,
+                0x00, 0x0E, 0x0C, 0x0E, 0x08, 0x0E, 0x0C, 0x0E, 0x00, 0x0E,
+                0x0C, 0x0E, 0x08, 0x0E, 0x0C, 0x0E, 0x00, 0x0E, 0x0C, 0x0E,
+                0x08, 0x0E, 0x0C, 0x0E, 0x20, 0x2E, 0x2C, 0x2E, 0x28, 0x2E,
+                0x2C, 0x2E, 0x20, 0x2E, 0x2C, 0x2E, 0x28, 0x2E, 0x2C, 0x2E,
+                0x20, 0x2E, 0x2C, 0x2E, 0x28, 0x2E, 0x2C, 0x2E, 0x20, 0x2E,
+                0x2C, 0x2E, 0x28, 0x2E, 0x2C, 0x2E, 0x20, 0x2E, 0x2C, 0x2E,
+                0x28, 0x2E, 0x2C, 0x2E, 0x20, 0x2E, 0x2C, 0x2E, 0x28, 0x2E,
+                0x2C, 0x2E, 0x20, 0x2E, 0x2C, 0x2E, 0x28, 0x2E, 0x2C, 0x2E,
+                0x20, 0x2E, 0x2C, 0x2E, 0x28, 0x2E, 0x2C, 0x2E, 0x60, 0x6E,
+                0x6C, 0x6E, 0x68, 0x6E, 0x6C, 0x6E, 0x60, 0x6E, 0x6C, 0x6E,
+                0x68, 0x6E, 0x6C, 0x6E, 0x60, 0x6E, 0x6C, 0x6E, 0x68, 0x6E,
+                0x6C, 0x6E, 0x60, 0x6E, 0x6C, 0x6E, 0x68, 0x6E, 0x6C, 0x6E,
+                0x60, 0x6E, 0x6C, 0x6E, 0x68, 0x6E, 0x6C, 0x6E, 0x60, 0x6E,
+                0x6C, 0x6E, 0x68, 0x6E, 0x6C, 0x6E, 0x60, 0x6E, 0x6C, 0x6E,
+                0x68, 0x6E, 0x6C, 0x6E, 0x60, 0x6E, 0x6C, 0x6E, 0x68, 0x6E,
+                0x6C, 0x6E, 0x60, 0x6E, 0x6C, 0x6E, 0x68, 0x6E, 0x6C, 0x6E,
+                0x60, 0x6E, 0x6C, 0x6E, 0x68, 0x6E, 0x6C, 0x6E, 0x60, 0x6E,
+                0x6C, 0x6E, 0x68, 0x6E, 0x6C, 0x6E, 0x60, 0x6E, 0x6C, 0x6E,
+                0x68, 0x6E, 0x6C, 0x6E, 0x60, 0x6E, 0x6C, 0x6E, 0x68, 0x6E,
+                0x6C, 0x6E, 0x60, 0x6E, 0x6C, 0x6E, 0x68, 0x6E, 0x6C, 0x6E,
+                0x60, 0x6E, 0x6C, 0x6E, 0x68, 0x6E, 0x6C, 0x6E, 0x60, 0x6E,
+                0x6C, 0x6E, 0x68, 0x6E, 0x6C, 0x6E
+        },
+        {
+                0x00, 0x1E, 0x1C, 0x1E, 0x18, 0x1E, 0x1C, 0x1E, 0x10, 0x1E,
+                0x1C, 0x1E, 0x18, 0x1E, 0x1C, 0x1E, 0x00, 0x1E, 0x1C, 0x1E,
+                0x18, 0x1E, 0x1C, 0x1E, 0x10, 0x1E, 0x1C, 0x1E, 0x18, 0x1E,
+                0x1C, 0x1E, 0x00, 0x1E, 0x1C, 0x1E, 0x18, 0x1E, 0x1C, 0x1E,
+                0x10, 0x1E, 0x1C, 0x1E, 0x18, 0x1E, 0x1C, 0x1E, 0x00, 0x1E,
+                0x1C, 0x1E, 0x18, 0x1E, 0x1C, 0x1E, 0x10, 0x1E, 0x1C, 0x1E,
+                0x18, 0x1E, 0x1C, 0x1E, 0x00, 0x1E, 0x1C, 0x1E, 0x18, 0x1E,
+                0x1C, 0x1E, 0x10, 0x1E, 0x1C, 0x1E, 0x18, 0x1E, 0x1C, 0x1E,
+                0x00, 0x1E, 0x1C, 0x1E, 0x18, 0x1E, 0x1C, 0x1E, 0x10, 0x1E,
+                0x1C, 0x1E, 0x18, 0x1E, 0x1C, 0x1E, 0x00, 0x1E, 0x1C, 0x1E,
+                0x18, 0x1E, 0x1C, 0x1E, 0x10, 0x1E, 0x1C, 0x1E, 0x18, 0x1E,
+                0x1C, 0x1E, 0x00, 0x1E, 0x1C, 0x1E, 0x18, 0x1E, 0x1C, 0x1E,
+                0x10, 0x1E, 0x1C, 0x1E, 0x18, 0x1E, 0x1C, 0x1E, 0x40, 0x5E,
+                0x5C, 0x5E, 0x58, 0x5E, 0x5C, 0x5E, 0x50, 0x5E, 0x5C, 0x5E,
+                0x58, 0x5E, 0x5C, 0x5E, 0x40, 0x5E, 0x5C, 0x5E, 0x58, 0x5E,
+                0x5C, 0x5E, 0x50, 0x5E, 0x5C, 0x5E, 0x58, 0x5E, 0x5C, 0x5E,
+                0x40, 0x5E, 0x5C, 0x5E, 0x58, 0x5E, 0x5C, 0x5E, 0x50, 0x5E,
+                0x5C, 0x5E, 0x58, 0x5E, 0x5C, 0x5E, 0x40, 0x5E, 0x5C, 0x5E,
+                0x58, 0x5E, 0x5C, 0x5E, 0x50, 0x5E, 0x5C, 0x5E, 0x58, 0x5E,
+                0x5C, 0x5E, 0x40, 0x5E, 0x5C, 0x5E, 0x58, 0x5E, 0x5C, 0x5E,
+                0x50, 0x5E, 0x5C, 0x5E, 0x58, 0x5E, 0x5C, 0x5E, 0x40, 0x5E,
+                0x5C, 0x5E, 0x58, 0x5E, 0x5C, 0x5E, 0x50, 0x5E, 0x5C, 0x5E,
+                0x58, 0x5E, 0x5C, 0x5E, 0x40, 0x5E, 0x5C, 0x5E, 0x58, 0x5E,
+                0x5C, 0x5E, 0x50, 0x5E, 0x5C, 0x5E, 0x58, 0x5E, 0x5C, 0x5E,
+                0x40, 0x5E, 0x5C, 0x5E, 0x58, 0x5E, 0x5C, 0x5E, 0x50, 0x5E,
+                0x5C, 0x5E, 0x58, 0x5E, 0x5C, 0x5E
+        },
+        {
+                0x00, 0x3E, 0x3C, 0x3E, 0x38, 0x3E, 0x3C, 0x3E, 0x30, 0x3E,
+                0x3C, 0x3E, 0x38, 0x3E, 0x3C, 0x3E, 0x20, 0x3E, 0x3C, 0x3E,
+                0x38, 0x3E, 0x3C, 0x3E, 0x30, 0x3E, 0x3C, 0x3E, 0x38, 0x3E,
+                0x3C, 0x3E, 0x00, 0x3E, 0x3C, 0x3E, 0x38, 0x3E, 0x3C, 0x3E,
+                0x30, 0x3E, 0x3C, 0x3E, 0x38, 0x3E, 0x3C, 0x3E, 0x20, 0x3E,
+                0x3C, 0x3E, 0x38, 0x3E, 0x3C, 0x3E, 0x30, 0x3E, 0x3C, 0x3E,
+                0x38, 0x3E, 0x3C, 0x3E, 0x00, 0x3E, 0x3C, 0x3E, 0x38, 0x3E,
+                0x3C, 0x3E, 0x30, 0x3E, 0x3C, 0x3E, 0x38, 0x3E, 0x3C, 0x3E,
+                0x20, 0x3E, 0x3C, 0x3E, 0x38, 0x3E, 0x3C, 0x3E, 0x30, 0x3E,
+                0x3C, 0x3E, 0x38, 0x3E, 0x3C, 0x3E, 0x00, 0x3E, 0x3C, 0x3E,
+                0x38, 0x3E, 0x3C, 0x3E, 0x30, 0x3E, 0x3C, 0x3E, 0x38, 0x3E,
+                0x3C, 0x3E, 0x20, 0x3E, 0x3C, 0x3E, 0x38, 0x3E, 0x3C, 0x3E,
+                0x30, 0x3E, 0x3C, 0x3E, 0x38, 0x3E, 0x3C, 0x3E, 0x00, 0x3E,
+                0x3C, 0x3E, 0x38, 0x3E, 0x3C, 0x3E, 0x30, 0x3E, 0x3C, 0x3E,
+                0x38, 0x3E, 0x3C, 0x3E, 0x20, 0x3E, 0x3C, 0x3E, 0x38, 0x3E,
+                0x3C, 0x3E, 0x30, 0x3E, 0x3C, 0x3E, 0x38, 0x3E, 0x3C, 0x3E,
+                0x00, 0x3E, 0x3C, 0x3E, 0x38, 0x3E, 0x3C, 0x3E, 0x30, 0x3E,
+                0x3C, 0x3E, 0x38, 0x3E, 0x3C, 0x3E, 0x20, 0x3E, 0x3C, 0x3E,
+                0x38, 0x3E, 0x3C, 0x3E, 0x30, 0x3E, 0x3C, 0x3E, 0x38, 0x3E,
+                0x3C, 0x3E, 0x00, 0x3E, 0x3C, 0x3E, 0x38, 0x3E, 0x3C, 0x3E,
+                0x30, 0x3E, 0x3C, 0x3E, 0x38, 0x3E, 0x3C, 0x3E, 0x20, 0x3E,
+                0x3C, 0x3E, 0x38, 0x3E, 0x3C, 0x3E, 0x30, 0x3E, 0x3C, 0x3E,
+                0x38, 0x3E, 0x3C, 0x3E, 0x00, 0x3E, 0x3C, 0x3E, 0x38, 0x3E,
+                0x3C, 0x3E, 0x30, 0x3E, 0x3C, 0x3E, 0x38, 0x3E, 0x3C, 0x3E,
+                0x20, 0x3E, 0x3C, 0x3E, 0x38, 0x3E, 0x3C, 0x3E, 0x30, 0x3E,
+                0x3C, 0x3E, 0x38, 0x3E, 0x3C, 0x3E
+        },
+        {
+                0x00, 0x7E, 0x7C, 0x7E, 0x78, 0x7E, 0x7C, 0x7E, 0x70, 0x7E,
+                0x7C, 0x7E, 0x78, 0x7E, 0x7C, 0x7E, 0x60, 0x7E, 0x7C, 0x7E,
+                0x78, 0x7E, 0x7C, 0x7E, 0x70, 0x7E, 0x7C, 0x7E, 0x78, 0x7E,
+                0x7C, 0x7E, 0x40, 0x7E, 0x7C, 0x7E, 0x78, 0x7E, 0x7C, 0x7E,
+                0x70, 0x7E, 0x7C, 0x7E, 0x78, 0x7E, 0x7C, 0x7E, 0x60, 0x7E,
+                0x7C, 0x7E, 0x78, 0x7E, 0x7C, 0x7E, 0x70, 0x7E, 0x7C, 0x7E,
+                0x78, 0x7E, 0x7C, 0x7E, 0x00, 0x7E, 0x7C, 0x7E, 0x78, 0x7E,
+                0x7C, 0x7E, 0x70, 0x7E, 0x7C, 0x7E, 0x78, 0x7E, 0x7C, 0x7E,
+                0x60, 0x7E, 0x7C, 0x7E, 0x78, 0x7E, 0x7C, 0x7E, 0x70, 0x7E,
+                0x7C, 0x7E, 0x78, 0x7E, 0x7C, 0x7E, 0x40, 0x7E, 0x7C, 0x7E,
+                0x78, 0x7E, 0x7C, 0x7E, 0x70, 0x7E, 0x7C, 0x7E, 0x78, 0x7E,
+                0x7C, 0x7E, 0x60, 0x7E, 0x7C, 0x7E, 0x78, 0x7E, 0x7C, 0x7E,
+                0x70, 0x7E, 0x7C, 0x7E, 0x78, 0x7E, 0x7C, 0x7E, 0x00, 0x7E,
+                0x7C, 0x7E, 0x78, 0x7E, 0x7C, 0x7E, 0x70, 0x7E, 0x7C, 0x7E,
+                0x78, 0x7E, 0x7C, 0x7E, 0x60, 0x7E, 0x7C, 0x7E, 0x78, 0x7E,
+                0x7C, 0x7E, 0x70, 0x7E, 0x7C, 0x7E, 0x78, 0x7E, 0x7C, 0x7E,
+                0x40, 0x7E, 0x7C, 0x7E, 0x78, 0x7E, 0x7C, 0x7E, 0x70, 0x7E,
+                0x7C, 0x7E, 0x78, 0x7E, 0x7C, 0x7E, 0x60, 0x7E, 0x7C, 0x7E,
+                0x78, 0x7E, 0x7C, 0x7E, 0x70, 0x7E, 0x7C, 0x7E, 0x78, 0x7E,
+                0x7C, 0x7E, 0x00, 0x7E, 0x7C, 0x7E, 0x78, 0x7E, 0x7C, 0x7E,
+                0x70, 0x7E, 0x7C, 0x7E, 0x78, 0x7E, 0x7C, 0x7E, 0x60, 0x7E,
+                0x7C, 0x7E, 0x78, 0x7E, 0x7C, 0x7E, 0x70, 0x7E, 0x7C, 0x7E,
+                0x78, 0x7E, 0x7C, 0x7E, 0x40, 0x7E, 0x7C, 0x7E, 0x78, 0x7E,
+                0x7C, 0x7E, 0x70, 0x7E, 0x7C, 0x7E, 0x78, 0x7E, 0x7C, 0x7E,
+                0x60, 0x7E, 0x7C, 0x7E, 0x78, 0x7E, 0x7C, 0x7E, 0x70, 0x7E,
+                0x7C, 0x7E, 0x78, 0x7E, 0x7C, 0x7E
+        }
+};
+
+static const uint64_t DIAG_MASKS[64] = {
+        0x8040201008040201ULL, 0x0080402010080402ULL,
+        0x0000804020100804ULL, 0x0000008040201008ULL,
+        0x0000000080402010ULL, 0x0000000000804020ULL,
+        0x0000000000008040ULL, 0x0000000000000080ULL,
+        0x4020100804020100ULL, 0x8040201008040201ULL,
+        0x0080402010080402ULL, 0x0000804020100804ULL,
+        0x0000008040201008ULL, 0x0000000080402010ULL,
+        0x0000000000804020ULL, 0x0000000000008040ULL,
+        0x2010080402010000ULL, 0x4020100804020100ULL,
+        0x8040201008040201ULL, 0x0080402010080402ULL,
+        0x0000804020100804ULL, 0x0000008040201008ULL,
+        0x0000000080402010ULL, 0x0000000000804020ULL,
+        0x1008040201000000ULL, 0x2010080402010000ULL,
+        0x4020100804020100ULL, 0x8040201008040201ULL,
+        0x0080402010080402ULL, 0x0000804020100804ULL,
+        0x0000008040201008ULL, 0x0000000080402010ULL,
+        0x0804020100000000ULL, 0x1008040201000000ULL,
+        0x2010080402010000ULL, 0x4020100804020100ULL,
+        0x8040201008040201ULL, 0x0080402010080402ULL,
+        0x0000804020100804ULL, 0x0000008040201008ULL,
+        0x0402010000000000ULL, 0x0804020100000000ULL,
+        0x1008040201000000ULL, 0x2010080402010000ULL,
+        0x4020100804020100ULL, 0x8040201008040201ULL,
+        0x0080402010080402ULL, 0x0000804020100804ULL,
+        0x0201000000000000ULL, 0x0402010000000000ULL,
+        0x0804020100000000ULL, 0x1008040201000000ULL,
+        0x2010080402010000ULL, 0x4020100804020100ULL,
+        0x8040201008040201ULL, 0x0080402010080402ULL,
+        0x0100000000000000ULL, 0x0201000000000000ULL,
+        0x0402010000000000ULL, 0x0804020100000000ULL,
+        0x1008040201000000ULL, 0x2010080402010000ULL,
+        0x4020100804020100ULL, 0x8040201008040201ULL
+};
+
+static const uint64_t ANTI_DIAG_MASKS[64] = {
+        0x0000000000000001ULL, 0x0000000000000102ULL,
+        0x0000000000010204ULL, 0x0000000001020408ULL,
+        0x0000000102040810ULL, 0x0000010204081020ULL,
+        0x0001020408102040ULL, 0x0102040810204080ULL,
+        0x0000000000000102ULL, 0x0000000000010204ULL,
+        0x0000000001020408ULL, 0x0000000102040810ULL,
+        0x0000010204081020ULL, 0x0001020408102040ULL,
+        0x0102040810204080ULL, 0x0204081020408000ULL,
+        0x0000000000010204ULL, 0x0000000001020408ULL,
+        0x0000000102040810ULL, 0x0000010204081020ULL,
+        0x0001020408102040ULL, 0x0102040810204080ULL,
+        0x0204081020408000ULL, 0x0408102040800000ULL,
+        0x0000000001020408ULL, 0x0000000102040810ULL,
+        0x0000010204081020ULL, 0x0001020408102040ULL,
+        0x0102040810204080ULL, 0x0204081020408000ULL,
+        0x0408102040800000ULL, 0x0810204080000000ULL,
+        0x0000000102040810ULL, 0x0000010204081020ULL,
+        0x0001020408102040ULL, 0x0102040810204080ULL,
+        0x0204081020408000ULL, 0x0408102040800000ULL,
+        0x0810204080000000ULL, 0x1020408000000000ULL,
+        0x0000010204081020ULL, 0x0001020408102040ULL,
+        0x0102040810204080ULL, 0x0204081020408000ULL,
+        0x0408102040800000ULL, 0x0810204080000000ULL,
+        0x1020408000000000ULL, 0x2040800000000000ULL,
+        0x0001020408102040ULL, 0x0102040810204080ULL,
+        0x0204081020408000ULL, 0x0408102040800000ULL,
+        0x0810204080000000ULL, 0x1020408000000000ULL,
+        0x2040800000000000ULL, 0x4080000000000000ULL,
+        0x0102040810204080ULL, 0x0204081020408000ULL,
+        0x0408102040800000ULL, 0x0810204080000000ULL,
+        0x1020408000000000ULL, 0x2040800000000000ULL,
+        0x4080000000000000ULL, 0x8000000000000000ULL
+};
+
+/* Gather the cells of a column into a byte, with row 0 in the lowest bit. */
+static int gather_column(uint64_t disks, int col)
+{
+        return (int)((((disks >> col) & 0x0101010101010101ULL) *
+                      0x0102040810204080ULL) >> 56);
+}
+
+/* Inverse of gather_column(). */
+static uint64_t spread_column(int bits, int col)
+{
+        uint64_t x;
+
+        /* Put bit i in row i, column i; then move each to column 7. */
+        x = ((uint64_t)bits * 0x0101010101010101ULL) & 0x8040201008040201ULL;
+        x = (x + 0x7F7F7F7F7F7F7F7FULL) & 0x8080808080808080ULL;
+
+        return x >> (7 - col);
+}
+
+/* Gather the cells of a diagonal into a byte, indexed by column. */
+static int gather_diag(uint64_t disks, uint64_t mask)
+{
+        return (int)(((disks & mask) * 0x0101010101010101ULL) >> 56);
+}
+
+/* Inverse of gather_diag(). */
+static uint64_t spread_diag(int bits, uint64_t mask)
+{
+        return ((uint64_t)bits * 0x0101010101010101ULL) & mask;
+}
+
+static int line_flips(int pos, int my_line, int opp_line)
+{
+        return FLIPPED[pos][OUTFLANK[pos][opp_line] & my_line];
+}
+
+/* Disks captured by placing a disk at board_idx; zero if the move is not
+   valid. */
+static uint64_t flipped_disks(uint64_t my_disks, uint64_t opp_disks,
+                              int board_idx)
+{
+        int row = board_idx / 8;
+        int col = board_idx % 8;
+        uint64_t diag = DIAG_MASKS[board_idx];
+        uint64_t anti_diag = ANTI_DIAG_MASKS[board_idx];
+        uint64_t captured_disks;
+        int f;
+
+        assert(board_idx < 64 && "Move must be within the board.");
+
+        f = line_flips(col, (int)(my_disks >> (row * 8)) & 0xFF,
+                       (int)(opp_disks >> (row * 8)) & 0xFF);
+        captured_disks = (uint64_t)f << (row * 8);
+
+        f = line_flips(row, gather_column(my_disks, col),
+                       gather_column(opp_disks, col));
+        captured_disks |= spread_column(f, col);
+
+        f = line_flips(col, gather_diag(my_disks, diag),
+                       gather_diag(opp_disks, diag));
+        captured_disks |= spread_diag(f, diag);
+
+        f = line_flips(col, gather_diag(my_disks, anti_diag),
+                       gather_diag(opp_disks, anti_diag));
+        captured_disks |= spread_diag(f, anti_diag);
+
+        return captured_disks;
+}
+
 static void resolve_move(uint64_t *my_disks, uint64_t *opp_disks, int board_idx)
 {
-        int dir;
-        uint64_t x, bounding_disk;
         uint64_t new_disk = 1ULL << board_idx;
-        uint64_t captured_disks = 0;
+        uint64_t captured_disks;
 
         assert(board_idx < 64 && "Move must be within the board.");
         assert((*my_disks & *opp_disks) == 0 && "Disk sets must be disjoint.");
         assert(!((*my_disks | *opp_disks) & new_disk) && "Target not empty!");
 
-        *my_disks |= new_disk;
-
-        for (dir = 0; dir < NUM_DIRS; dir++) {
-                /* Find opponent disk adjacent to the new disk. */
-                x = shift(new_disk, dir) & *opp_disks;
-
-                /* Add any adjacent opponent disk to that one, and so on. */
-                x |= shift(x, dir) & *opp_disks;
-                x |= shift(x, dir) & *opp_disks;
-                x |= shift(x, dir) & *opp_disks;
-                x |= shift(x, dir) & *opp_disks;
-                x |= shift(x, dir) & *opp_disks;
-
-                /* Determine whether the disks were captured. */
-                bounding_disk = shift(x, dir) & *my_disks;
-                captured_disks |= (bounding_disk ? x : 0);
-        }
+        captured_disks = flipped_disks(*my_disks, *opp_disks, board_idx);
 
         assert(captured_disks && "A valid move must capture disks.");
 
+        *my_disks |= new_disk;
         *my_disks ^= captured_disks;
         *opp_disks ^= captured_disks;
 
@@ -208,6 +1067,50 @@ void othello_make_move(othello_t *o, player_t p, int row, int col)
         resolve_move(&o->disks[p], &o->disks[p ^ 1], row * 8 + col);
 }
 
+/* Count the leaves of the game tree to the given depth. A pass counts as a
+   move, and a finished game as a leaf. */
+static uint64_t perft(uint64_t my_disks, uint64_t opp_disks, int depth,
+                      bool bulk)
+{
+        uint64_t moves, my, opp, n;
+        int idx;
+
+        if (depth == 0) {
+                return 1;
+        }
+
+        moves = generate_moves(my_disks, opp_disks);
+        if (!moves) {
+                if (!generate_moves(opp_disks, my_disks)) {
+                        return 1;
+                }
+                return perft(opp_disks, my_disks, depth - 1, bulk);
+        }
+        if (bulk && depth == 1) {
+                /* Count the moves instead of making them. */
+                return (uint64_t)popcount(moves);
+        }
+
+        n = 0;
+        while (moves) {
+                idx = ctz(moves);
+                moves &= moves - 1;
+                my = my_disks;
+                opp = opp_disks;
+                resolve_move(&my, &opp, idx);
+                n += perft(opp, my, depth - 1, bulk);
+        }
+
+        return n;
+}
+
+uint64_t othello_perft(const othello_t *o, player_t p, int depth, bool bulk)
+{
+        assert(depth >= 0);
+
+        return perft(o->disks[p], o->disks[p ^ 1], depth, bulk);
+}
+
 static void frontier_disks(uint64_t my_disks, uint64_t opp_disks,
                            uint64_t *my_frontier, uint64_t *opp_frontier)
 {
@@ -226,156 +1129,3963 @@ static void frontier_disks(uint64_t my_disks, uint64_t opp_disks,
         }
 }
 
-#define WIN_BONUS (1 << 20)
+/* Spread x along lines in one direction, like kogge_stone_left() and
+   kogge_stone_right() but through every cell. */
+static uint64_t fill_left(uint64_t x, int n, uint64_t mask)
+{
+        uint64_t pro = mask;
 
-static int eval(uint64_t my_disks, uint64_t opp_disks,
-                uint64_t my_moves, uint64_t opp_moves)
+        x |= pro & (x << n);
+        pro &= pro << n;
+        x |= pro & (x << (2 * n));
+        pro &= pro << (2 * n);
+        x |= pro & (x << (4 * n));
+
+        return x;
+}
+
+static uint64_t fill_right(uint64_t x, int n, uint64_t mask)
 {
-        static const uint64_t CORNER_MASK = 0x8100000000000081ULL;
+        uint64_t pro = mask;
 
-        int my_disk_count, opp_disk_count;
-        uint64_t my_corners, opp_corners;
-        uint64_t my_frontier, opp_frontier;
-        int score = 0;
+        x |= pro & (x >> n);
+        pro &= pro >> n;
+        x |= pro & (x >> (2 * n));
+        pro &= pro >> (2 * n);
+        x |= pro & (x >> (4 * n));
 
-        if (!my_moves && !opp_moves) {
-                /* Terminal state. */
-                my_disk_count = popcount(my_disks);
-                opp_disk_count = popcount(opp_disks);
-                return (my_disk_count - opp_disk_count) * WIN_BONUS;
-        }
+        return x;
+}
 
-        my_corners = my_disks & CORNER_MASK;
-        opp_corners = opp_disks & CORNER_MASK;
+/* Cells whose line along one axis has no empty cells. */
+static uint64_t full_lines(uint64_t empty_cells, int n, uint64_t left_mask,
+                           uint64_t right_mask)
+{
+        return ~(fill_left(empty_cells, n, left_mask) |
+                 fill_right(empty_cells, n, right_mask));
+}
 
-        frontier_disks(my_disks, opp_disks, &my_frontier, &opp_frontier);
+/* Disks that can never be flipped. A disk can only be flipped along an axis
+   (horizontal, vertical or one of the diagonals) if both its neighbours on
+   that axis are on the board and the line has an empty cell. It is safe
+   along the axis if the line is full, or if one of the neighbours is a
+   stable disk of its own colour, and stable if it is safe along all four.
+   Starting from the corners, stability spreads along the edges and then
+   inwards until nothing changes. */
+static uint64_t stable_disks(uint64_t disks, uint64_t empty_cells)
+{
+        static const uint64_t NOT_A = 0xFEFEFEFEFEFEFEFEULL;
+        static const uint64_t NOT_H = 0x7F7F7F7F7F7F7F7FULL;
+        static const uint64_t EDGE_COLS = 0x8181818181818181ULL;
+        static const uint64_t EDGE_ROWS = 0xFF000000000000FFULL;
+        static const uint64_t EDGES = 0xFF818181818181FFULL;
 
-        /* Optimize for corners, mobility and few frontier disks. */
-        score += (popcount(my_corners) - popcount(opp_corners)) * 16;
-        score += (popcount(my_moves) - popcount(opp_moves)) * 2;
-        score += (popcount(my_frontier) - popcount(opp_frontier)) * -1;
+        uint64_t horiz, vert, diag, anti_diag, stable, prev;
 
-        assert(abs(score) < WIN_BONUS);
+        /* Disks safe along each axis whatever their neighbours. */
+        horiz = disks & (full_lines(empty_cells, 1, NOT_A, NOT_H) | EDGE_COLS);
+        vert = disks & (full_lines(empty_cells, 8, ~0ULL, ~0ULL) | EDGE_ROWS);
+        diag = disks & (full_lines(empty_cells, 9, NOT_A, NOT_H) | EDGES);
+        anti_diag = disks & (full_lines(empty_cells, 7, NOT_H, NOT_A) | EDGES);
 
-        return score;
+        stable = horiz & vert & diag & anti_diag;
+        if (!stable) {
+                return 0;
+        }
+
+        do {
+                prev = stable;
+                stable = (horiz | ((prev << 1) & NOT_A) |
+                                  ((prev >> 1) & NOT_H)) &
+                         (vert | (prev << 8) | (prev >> 8)) &
+                         (diag | ((prev << 9) & NOT_A) |
+                                 ((prev >> 9) & NOT_H)) &
+                         (anti_diag | ((prev << 7) & NOT_H) |
+                                      ((prev >> 7) & NOT_A)) &
+                         disks;
+        } while (stable != prev);
+
+        return stable;
 }
 
-int othello_eval(const othello_t *o, player_t p)
+uint64_t othello_stable_disks(const othello_t *o, player_t p)
 {
-        uint64_t my_disks, opp_disks, my_moves, opp_moves;
+        return stable_disks(o->disks[p], ~(o->disks[0] | o->disks[1]));
+}
 
-        my_disks = o->disks[p];
-        opp_disks = o->disks[p ^ 1];
-        my_moves = generate_moves(my_disks, opp_disks);
-        opp_moves = generate_moves(opp_disks, my_disks);
+/* Board symmetries. The diagonal reflection does not commute with the
+   mirrors: undoing it after a single mirror needs the other one. */
+
+static const int8_t INVERSE_TRANSFORM[OTHELLO_NUM_TRANSFORMS] = {
+        0, 1, 2, 3, 4, 6, 5, 7
+};
 
-        return eval(my_disks, opp_disks, my_moves, opp_moves);
+static uint64_t flip_vertical(uint64_t x)
+{
+#ifdef __GNUC__
+        return __builtin_bswap64(x);
+#else
+        x = ((x >> 8) & 0x00FF00FF00FF00FFULL) |
+            ((x & 0x00FF00FF00FF00FFULL) << 8);
+        x = ((x >> 16) & 0x0000FFFF0000FFFFULL) |
+            ((x & 0x0000FFFF0000FFFFULL) << 16);
+        return (x >> 32) | (x << 32);
+#endif
 }
 
-static int negamax(uint64_t my_disks, uint64_t opp_disks, int max_depth,
-                   int alpha, int beta, int *best_move, int *eval_count)
+static uint64_t mirror_horizontal(uint64_t x)
 {
-        uint64_t my_moves, opp_moves;
-        uint64_t my_new_disks, opp_new_disks;
-        int i, s, best;
+        x = ((x >> 1) & 0x5555555555555555ULL) |
+            ((x & 0x5555555555555555ULL) << 1);
+        x = ((x >> 2) & 0x3333333333333333ULL) |
+            ((x & 0x3333333333333333ULL) << 2);
+        return ((x >> 4) & 0x0F0F0F0F0F0F0F0FULL) |
+               ((x & 0x0F0F0F0F0F0F0F0FULL) << 4);
+}
 
-        /* Generate moves. */
-        my_moves = generate_moves(my_disks, opp_disks);
-        opp_moves = generate_moves(opp_disks, my_disks);
+/* Swap rows and columns, with delta swaps of ever smaller blocks. */
+static uint64_t flip_diagonal(uint64_t x)
+{
+        uint64_t t;
 
-        if (!my_moves && opp_moves) {
-                /* Null move. */
-                return -negamax(opp_disks, my_disks, max_depth, -beta, -alpha,
-                                best_move, eval_count);
-        }
+        t = 0x0F0F0F0F00000000ULL & (x ^ (x << 28));
+        x ^= t ^ (t >> 28);
+        t = 0x3333000033330000ULL & (x ^ (x << 14));
+        x ^= t ^ (t >> 14);
+        t = 0x5500550055005500ULL & (x ^ (x << 7));
+        x ^= t ^ (t >> 7);
 
-        if (max_depth == 0 || (!my_moves && !opp_moves)) {
-                /* Maximum depth or terminal state reached. */
-                ++*eval_count;
-                return eval(my_disks, opp_disks, my_moves, opp_moves);
+        return x;
+}
+
+static uint64_t transform(uint64_t x, int t)
+{
+        if (t & 4) {
+                x = flip_diagonal(x);
+        }
+        if (t & 1) {
+                x = mirror_horizontal(x);
+        }
+        if (t & 2) {
+                x = flip_vertical(x);
         }
 
-        /* Find the best move. */
-        assert(alpha < beta);
-        best = -INT_MAX;
-        for (i = 0; i < 64; i++) {
-                if (!(my_moves & (1ULL << i))) {
-                        continue;
-                }
-                my_new_disks = my_disks;
-                opp_new_disks = opp_disks;
-                resolve_move(&my_new_disks, &opp_new_disks, i);
+        return x;
+}
 
-                s = -negamax(opp_new_disks, my_new_disks,
-                             max_depth - 1, -beta, -alpha, NULL,
-                             eval_count);
+uint64_t othello_transform_cells(uint64_t cells, int t)
+{
+        assert(t >= 0 && t < OTHELLO_NUM_TRANSFORMS);
 
-                if (s > best) {
-                        best = s;
-                        if (best_move) {
-                                *best_move = i;
-                        }
-                        alpha = s > alpha ? s : alpha;
+        return transform(cells, t);
+}
 
-                        if (alpha >= beta) {
-                                break;
-                        }
-                }
-        }
+int othello_inverse_transform(int t)
+{
+        assert(t >= 0 && t < OTHELLO_NUM_TRANSFORMS);
 
-        return best;
+        return INVERSE_TRANSFORM[t];
 }
 
-int othello_negamax(const othello_t *o, player_t p, int depth)
+void othello_transform(const othello_t *o, int t, othello_t *out)
 {
-        int best_move, eval_count;
+        assert(t >= 0 && t < OTHELLO_NUM_TRANSFORMS);
 
-        return negamax(o->disks[p], o->disks[p ^ 1], depth, -INT_MAX, INT_MAX,
-                       &best_move, &eval_count);
+        out->disks[0] = transform(o->disks[0], t);
+        out->disks[1] = transform(o->disks[1], t);
 }
 
-static int iterative_negamax(uint64_t my_disks, uint64_t opp_disks,
-                             int start_depth, int eval_budget)
+/* All transformations of x, sharing the steps they have in common. */
+static void transform_all(uint64_t x, uint64_t *out)
 {
-        int depth, best_move, eval_count, s;
+        out[0] = x;
+        out[1] = mirror_horizontal(x);
+        out[2] = flip_vertical(x);
+        out[3] = flip_vertical(out[1]);
+        out[4] = flip_diagonal(x);
+        out[5] = mirror_horizontal(out[4]);
+        out[6] = flip_vertical(out[4]);
+        out[7] = flip_vertical(out[5]);
+}
 
-        assert(start_depth > 0 && "At least one move must be explored.");
+/* Replace a position with its canonical form, the transformation with the
+   smallest (my_disks, opp_disks), and return the transformation. */
+static int canonical_form(uint64_t *my_disks, uint64_t *opp_disks)
+{
+        uint64_t my[OTHELLO_NUM_TRANSFORMS], opp[OTHELLO_NUM_TRANSFORMS];
+        int t, best = 0;
 
-        eval_count = 0;
-        best_move = -1;
-        for (depth = start_depth; eval_count < eval_budget; depth++) {
-                s = negamax(my_disks, opp_disks, depth, -INT_MAX, INT_MAX,
-                            &best_move, &eval_count);
-                if (s >= WIN_BONUS || -s >= WIN_BONUS) {
-                        break;
+        transform_all(*my_disks, my);
+        transform_all(*opp_disks, opp);
+        for (t = 1; t < OTHELLO_NUM_TRANSFORMS; t++) {
+                if (my[t] < my[best] ||
+                    (my[t] == my[best] && opp[t] < opp[best])) {
+                        best = t;
                 }
         }
 
-        assert(best_move != -1 && "No move found?");
+        *my_disks = my[best];
+        *opp_disks = opp[best];
 
-        return best_move;
+        return best;
 }
 
-int othello_iterative_negamax(const othello_t *o, player_t p, int budget)
+int othello_canonical(const othello_t *o, othello_t *out)
 {
-        return iterative_negamax(o->disks[p], o->disks[p ^ 1], 1, budget);
+        *out = *o;
+
+        return canonical_form(&out->disks[0], &out->disks[1]);
 }
 
-void othello_compute_move(const othello_t *o, player_t p, int *row, int *col)
-{
-        int move_idx;
+#define WIN_BONUS (1 << 20)
 
-        static const int START_DEPTH = 8;
-        static const int EVAL_BUDGET = 500000;
+/* Pattern evaluation: the board is covered by lines and corner regions, and
+   each instance of a pattern is scored by looking up the configuration of
+   its squares, as a base-3 number, in a table of trained weights. Instances
+   that are rotations or reflections of each other share a table. */
 
-        assert(othello_has_valid_move(o, p));
+typedef enum {
+        PATTERN_EDGE_2X,        /* An edge plus the two X-squares. */
+        PATTERN_CORNER_3X3,
+        PATTERN_CORNER_2X5,
+        PATTERN_ROW_2,          /* Second row or column from an edge. */
+        PATTERN_ROW_3,
+        PATTERN_ROW_4,
+        PATTERN_DIAG_8,
+        PATTERN_DIAG_7,
+        PATTERN_DIAG_6,
+        PATTERN_DIAG_5,
+        PATTERN_DIAG_4,
+        NUM_PATTERN_TYPES
+} pattern_type_t;
 
-        move_idx = iterative_negamax(o->disks[p], o->disks[p ^ 1],
-                                     START_DEPTH, EVAL_BUDGET);
+/* Offset of each pattern type's table of 3^size weights within a phase. */
+static const int PATTERN_OFFSET[NUM_PATTERN_TYPES] = {
+        0, 59049, 78732, 137781, 144342, 150903, 157464, 164025, 166212,
+        166941, 167184
+};
 
-        *row = move_idx / 8;
-        *col = move_idx % 8;
-}
+/* Weights per phase. */
+#define PATTERN_WEIGHTS (167184 + 81)
+
+/* Game phases, by number of disks on the board. */
+#define PATTERN_PHASES 13
+#define PATTERN_PHASE(disks) (((disks) - 4) / 5)
+
+#define MAX_PATTERN_SIZE 10
+
+typedef struct {
+        pattern_type_t type;
+        int size;
+        int8_t squares[MAX_PATTERN_SIZE];
+} pattern_t;
+
+static const pattern_t PATTERNS[] = {
+        { PATTERN_EDGE_2X, 10, { 0, 1, 2, 3, 4, 5, 6, 7, 9, 14 } },
+        { PATTERN_EDGE_2X, 10, { 56, 57, 58, 59, 60, 61, 62, 63, 49, 54 } },
+        { PATTERN_EDGE_2X, 10, { 0, 8, 16, 24, 32, 40, 48, 56, 9, 49 } },
+        { PATTERN_EDGE_2X, 10, { 7, 15, 23, 31, 39, 47, 55, 63, 14, 54 } },
+        { PATTERN_CORNER_3X3, 9, { 0, 1, 2, 8, 9, 10, 16, 17, 18 } },
+        { PATTERN_CORNER_3X3, 9, { 7, 6, 5, 15, 14, 13, 23, 22, 21 } },
+        { PATTERN_CORNER_3X3, 9, { 56, 57, 58, 48, 49, 50, 40, 41, 42 } },
+        { PATTERN_CORNER_3X3, 9, { 63, 62, 61, 55, 54, 53, 47, 46, 45 } },
+        { PATTERN_CORNER_2X5, 10, { 0, 1, 2, 3, 4, 8, 9, 10, 11, 12 } },
+        { PATTERN_CORNER_2X5, 10, { 7, 6, 5, 4, 3, 15, 14, 13, 12, 11 } },
+        { PATTERN_CORNER_2X5, 10, { 56, 57, 58, 59, 60, 48, 49, 50, 51, 52 } },
+        { PATTERN_CORNER_2X5, 10, { 63, 62, 61, 60, 59, 55, 54, 53, 52, 51 } },
+        { PATTERN_CORNER_2X5, 10, { 0, 8, 16, 24, 32, 1, 9, 17, 25, 33 } },
+        { PATTERN_CORNER_2X5, 10, { 56, 48, 40, 32, 24, 57, 49, 41, 33, 25 } },
+        { PATTERN_CORNER_2X5, 10, { 7, 15, 23, 31, 39, 6, 14, 22, 30, 38 } },
+        { PATTERN_CORNER_2X5, 10, { 63, 55, 47, 39, 31, 62, 54, 46, 38, 30 } },
+        { PATTERN_ROW_2, 8, { 8, 9, 10, 11, 12, 13, 14, 15 } },
+        { PATTERN_ROW_2, 8, { 48, 49, 50, 51, 52, 53, 54, 55 } },
+        { PATTERN_ROW_2, 8, { 1, 9, 17, 25, 33, 41, 49, 57 } },
+        { PATTERN_ROW_2, 8, { 6, 14, 22, 30, 38, 46, 54, 62 } },
+        { PATTERN_ROW_3, 8, { 16, 17, 18, 19, 20, 21, 22, 23 } },
+        { PATTERN_ROW_3, 8, { 40, 41, 42, 43, 44, 45, 46, 47 } },
+        { PATTERN_ROW_3, 8, { 2, 10, 18, 26, 34, 42, 50, 58 } },
+        { PATTERN_ROW_3, 8, { 5, 13, 21, 29, 37, 45, 53, 61 } },
+        { PATTERN_ROW_4, 8, { 24, 25, 26, 27, 28, 29, 30, 31 } },
+        { PATTERN_ROW_4, 8, { 32, 33, 34, 35, 36, 37, 38, 39 } },
+        { PATTERN_ROW_4, 8, { 3, 11, 19, 27, 35, 43, 51, 59 } },
+        { PATTERN_ROW_4, 8, { 4, 12, 20, 28, 36, 44, 52, 60 } },
+        { PATTERN_DIAG_8, 8, { 0, 9, 18, 27, 36, 45, 54, 63 } },
+        { PATTERN_DIAG_8, 8, { 7, 14, 21, 28, 35, 42, 49, 56 } },
+        { PATTERN_DIAG_7, 7, { 1, 10, 19, 28, 37, 46, 55 } },
+        { PATTERN_DIAG_7, 7, { 6, 13, 20, 27, 34, 41, 48 } },
+        { PATTERN_DIAG_7, 7, { 57, 50, 43, 36, 29, 22, 15 } },
+        { PATTERN_DIAG_7, 7, { 62, 53, 44, 35, 26, 17, 8 } },
+        { PATTERN_DIAG_6, 6, { 2, 11, 20, 29, 38, 47 } },
+        { PATTERN_DIAG_6, 6, { 5, 12, 19, 26, 33, 40 } },
+        { PATTERN_DIAG_6, 6, { 58, 51, 44, 37, 30, 23 } },
+        { PATTERN_DIAG_6, 6, { 61, 52, 43, 34, 25, 16 } },
+        { PATTERN_DIAG_5, 5, { 3, 12, 21, 30, 39 } },
+        { PATTERN_DIAG_5, 5, { 4, 11, 18, 25, 32 } },
+        { PATTERN_DIAG_5, 5, { 59, 52, 45, 38, 31 } },
+        { PATTERN_DIAG_5, 5, { 60, 51, 42, 33, 24 } },
+        { PATTERN_DIAG_4, 4, { 4, 13, 22, 31 } },
+        { PATTERN_DIAG_4, 4, { 3, 10, 17, 24 } },
+        { PATTERN_DIAG_4, 4, { 60, 53, 46, 39 } },
+        { PATTERN_DIAG_4, 4, { 59, 50, 41, 32 } },
+};
+
+#define NUM_PATTERNS ((int)(sizeof(PATTERNS) / sizeof(PATTERNS[0])))
+
+/* Weight file layout: the header, followed by PATTERN_PHASES tables of
+   PATTERN_WEIGHTS little-endian int16_t weights. */
+
+#define WEIGHTS_MAGIC "OTHWGHTS"
+#define WEIGHTS_VERSION 1
+
+typedef struct {
+        char magic[8];
+        uint32_t version;
+        uint32_t phases;
+        uint32_t weights;       /* Weights per phase. */
+        uint32_t reserved;
+} weights_header_t;
+
+static othello_evaluator_t evaluator = OTHELLO_EVAL_BUILTIN;
+
+/* The mapped weight file, or NULL if not loaded. */
+static const int16_t *weights;
+static const void *weights_map;
+static size_t weights_map_size;
+
+/* The patterns each square is part of, and the power of 3 of its digit. */
+
+#define MAX_SQUARE_PATTERNS 8
+
+typedef struct {
+        int n;
+        uint8_t pattern[MAX_SQUARE_PATTERNS];
+        uint16_t power[MAX_SQUARE_PATTERNS];
+} square_patterns_t;
+
+static square_patterns_t square_patterns[64];
+static bool square_patterns_initialized;
+
+static void init_square_patterns(void)
+{
+        square_patterns_t *sp;
+        int i, j, power;
+
+        if (square_patterns_initialized) {
+                return;
+        }
+
+        for (i = 0; i < NUM_PATTERNS; i++) {
+                power = 1;
+                for (j = PATTERNS[i].size - 1; j >= 0; j--) {
+                        sp = &square_patterns[PATTERNS[i].squares[j]];
+                        assert(sp->n < MAX_SQUARE_PATTERNS);
+                        sp->pattern[sp->n] = (uint8_t)i;
+                        sp->power[sp->n] = (uint16_t)power;
+                        sp->n++;
+                        power *= 3;
+                }
+        }
+
+        square_patterns_initialized = true;
+}
+
+/* Keep evaluations clear of the scores of finished games. */
+static int clamp_eval(int score)
+{
+        if (score >= WIN_BONUS) {
+                return WIN_BONUS - 1;
+        }
+        if (score <= -WIN_BONUS) {
+                return -WIN_BONUS + 1;
+        }
+
+        return score;
+}
+
+static int pattern_code(uint64_t my_disks, uint64_t opp_disks,
+                        const pattern_t *pat)
+{
+        int code = 0;
+        int i, sq;
+
+        for (i = 0; i < pat->size; i++) {
+                /* 0: empty, 1: mine, 2: opponent's. */
+                sq = pat->squares[i];
+                code = code * 3 + (int)((my_disks >> sq) & 1) +
+                       2 * (int)((opp_disks >> sq) & 1);
+        }
+
+        return code;
+}
+
+/* Apply (sign 1) or take back (sign -1) a move by the side to move: the
+   placed disk adds a 1 digit to its codes and a 2 digit to the opponent's,
+   and each flipped disk turns a 2 digit into 1 and vice versa. */
+static void pattern_update(uint16_t *mine, uint16_t *theirs, int sign,
+                           int move_idx, uint64_t flipped)
+{
+        const square_patterns_t *sp;
+        int i, sq;
+
+        sp = &square_patterns[move_idx];
+        for (i = 0; i < sp->n; i++) {
+                mine[sp->pattern[i]] += (uint16_t)(sign * sp->power[i]);
+                theirs[sp->pattern[i]] += (uint16_t)(sign * 2 * sp->power[i]);
+        }
+
+        while (flipped) {
+                sq = ctz(flipped);
+                flipped &= flipped - 1;
+
+                sp = &square_patterns[sq];
+                for (i = 0; i < sp->n; i++) {
+                        mine[sp->pattern[i]] -= (uint16_t)(sign *
+                                                          sp->power[i]);
+                        theirs[sp->pattern[i]] += (uint16_t)(sign *
+                                                            sp->power[i]);
+                }
+        }
+}
+
+/* Evaluate with the given codes for the side to move, or compute them if
+   codes is NULL. */
+static int pattern_eval(uint64_t my_disks, uint64_t opp_disks,
+                        const uint16_t *codes)
+{
+        const int16_t *w;
+        int i, code, score = 0;
+
+        w = weights + PATTERN_PHASE(popcount(my_disks | opp_disks)) *
+                      PATTERN_WEIGHTS;
+
+        for (i = 0; i < NUM_PATTERNS; i++) {
+                if (codes != NULL) {
+                        code = codes[i];
+#ifdef OTHELLO_CHECK_INCREMENTAL
+                        if (code != pattern_code(my_disks, opp_disks,
+                                                 &PATTERNS[i])) {
+                                fprintf(stderr, "pattern %d: code %d, "
+                                        "expected %d\n", i, code,
+                                        pattern_code(my_disks, opp_disks,
+                                                     &PATTERNS[i]));
+                                abort();
+                        }
+#endif
+                } else {
+                        code = pattern_code(my_disks, opp_disks, &PATTERNS[i]);
+                }
+                score += w[PATTERN_OFFSET[PATTERNS[i].type] + code];
+        }
+
+        return clamp_eval(score);
+}
+
+static void unmap_file(const void *map, size_t size)
+{
+#ifdef _WIN32
+        (void)size;
+        UnmapViewOfFile(map);
+#else
+        munmap((void *)map, size);
+#endif
+}
+
+/* Map a file read-only into memory. Returns NULL on failure. */
+static const void *map_file(const char *path, size_t *size)
+{
+#ifdef _WIN32
+        HANDLE file, mapping;
+        LARGE_INTEGER file_size;
+        const void *map = NULL;
+
+        file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL,
+                           OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file == INVALID_HANDLE_VALUE) {
+                return NULL;
+        }
+        if (GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0) {
+                mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0,
+                                             NULL);
+                if (mapping != NULL) {
+                        map = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+                        CloseHandle(mapping);
+                }
+                *size = (size_t)file_size.QuadPart;
+        }
+        CloseHandle(file);
+
+        return map;
+#else
+        struct stat st;
+        void *map;
+        int fd;
+
+        fd = open(path, O_RDONLY);
+        if (fd < 0) {
+                return NULL;
+        }
+        if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+                close(fd);
+                return NULL;
+        }
+        map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (map == MAP_FAILED) {
+                return NULL;
+        }
+        *size = (size_t)st.st_size;
+
+        return map;
+#endif
+}
+
+/* Move a file over another, which must not be mapped. Returns false on
+   failure. */
+static bool replace_file(const char *from, const char *to)
+{
+#ifdef _WIN32
+        return MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+        return rename(from, to) == 0;
+#endif
+}
+
+bool othello_load_weights(const char *path)
+{
+        const weights_header_t *header;
+        const void *map;
+        size_t size = 0;
+
+        assert(sizeof(weights_header_t) == 24);
+
+        map = map_file(path, &size);
+        if (map == NULL) {
+                return false;
+        }
+
+        header = map;
+        if (size != sizeof(*header) + (size_t)PATTERN_PHASES *
+                    PATTERN_WEIGHTS * sizeof(int16_t) ||
+            memcmp(header->magic, WEIGHTS_MAGIC, 8) != 0 ||
+            header->version != WEIGHTS_VERSION ||
+            header->phases != PATTERN_PHASES ||
+            header->weights != PATTERN_WEIGHTS) {
+                unmap_file(map, size);
+                return false;
+        }
+
+        init_square_patterns();
+        othello_unload_weights();
+        weights_map = map;
+        weights_map_size = size;
+        weights = (const int16_t *)(header + 1);
+        evaluator = OTHELLO_EVAL_PATTERNS;
+
+        return true;
+}
+
+void othello_unload_weights(void)
+{
+        if (weights_map != NULL) {
+                unmap_file(weights_map, weights_map_size);
+        }
+        weights = NULL;
+        weights_map = NULL;
+        weights_map_size = 0;
+        if (evaluator == OTHELLO_EVAL_PATTERNS) {
+                evaluator = OTHELLO_EVAL_BUILTIN;
+        }
+}
+
+bool othello_save_weights(const char *path, const int16_t *w)
+{
+        weights_header_t header;
+        FILE *f;
+        bool ok;
+
+        assert(OTHELLO_NUM_WEIGHTS == PATTERN_PHASES * PATTERN_WEIGHTS);
+
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, WEIGHTS_MAGIC, sizeof(header.magic));
+        header.version = WEIGHTS_VERSION;
+        header.phases = PATTERN_PHASES;
+        header.weights = PATTERN_WEIGHTS;
+
+        f = fopen(path, "wb");
+        if (f == NULL) {
+                return false;
+        }
+        ok = fwrite(&header, sizeof(header), 1, f) == 1 &&
+             fwrite(w, sizeof(*w), OTHELLO_NUM_WEIGHTS, f) ==
+             OTHELLO_NUM_WEIGHTS;
+
+        return fclose(f) == 0 && ok;
+}
+
+int othello_pattern_features(const othello_t *o, player_t p, int *features)
+{
+        uint64_t my_disks = o->disks[p];
+        uint64_t opp_disks = o->disks[p ^ 1];
+        int i, phase_offset;
+
+        assert(OTHELLO_NUM_PATTERNS == NUM_PATTERNS);
+
+        phase_offset = PATTERN_PHASE(popcount(my_disks | opp_disks)) *
+                       PATTERN_WEIGHTS;
+        for (i = 0; i < NUM_PATTERNS; i++) {
+                features[i] = phase_offset + PATTERN_OFFSET[PATTERNS[i].type] +
+                              pattern_code(my_disks, opp_disks, &PATTERNS[i]);
+        }
+
+        return NUM_PATTERNS;
+}
+
+/* Neural network evaluation, NNUE style: the first layer's outputs for the
+   position (the accumulator) only change by a row of weights per changed
+   disk, so the search updates them as moves are made, and only the small
+   layers after it are computed at each leaf. */
+
+#define NET_INPUTS OTHELLO_NET_INPUTS
+#define NET_HIDDEN1 OTHELLO_NET_HIDDEN1
+#define NET_HIDDEN2 OTHELLO_NET_HIDDEN2
+#define NET_ONE OTHELLO_NET_ONE
+
+#define NETWORK_MAGIC "OTHNNUE1"
+#define NETWORK_VERSION 1
+
+typedef struct {
+        char magic[8];
+        uint32_t version;
+        uint32_t inputs;
+        uint32_t hidden1;
+        uint32_t hidden2;
+} network_header_t;
+
+/* The mapped network file, or NULL if not loaded. */
+static const othello_network_t *network;
+static const void *network_map;
+static size_t network_map_size;
+
+static void network_refresh(const othello_network_t *net, uint64_t my_disks,
+                            uint64_t opp_disks, int16_t *acc)
+{
+        int j, sq;
+
+        for (j = 0; j < NET_HIDDEN1; j++) {
+                acc[j] = net->b1[j];
+        }
+        while (my_disks) {
+                sq = ctz(my_disks);
+                my_disks &= my_disks - 1;
+                for (j = 0; j < NET_HIDDEN1; j++) {
+                        acc[j] += net->w1[sq][j];
+                }
+        }
+        while (opp_disks) {
+                sq = ctz(opp_disks);
+                opp_disks &= opp_disks - 1;
+                for (j = 0; j < NET_HIDDEN1; j++) {
+                        acc[j] += net->w1[64 + sq][j];
+                }
+        }
+}
+
+/* Like pattern_update(): the placed disk is an input for both sides, and a
+   flipped disk moves from the opponent's inputs to the mover's. */
+static void network_update(const othello_network_t *net, int16_t *mine,
+                           int16_t *theirs, int sign, int move_idx,
+                           uint64_t flipped)
+{
+        const int16_t *my_row, *opp_row;
+        int j, sq;
+
+        my_row = net->w1[move_idx];
+        opp_row = net->w1[64 + move_idx];
+        for (j = 0; j < NET_HIDDEN1; j++) {
+                mine[j] += (int16_t)(sign * my_row[j]);
+                theirs[j] += (int16_t)(sign * opp_row[j]);
+        }
+
+        while (flipped) {
+                sq = ctz(flipped);
+                flipped &= flipped - 1;
+
+                my_row = net->w1[sq];
+                opp_row = net->w1[64 + sq];
+                for (j = 0; j < NET_HIDDEN1; j++) {
+                        mine[j] += (int16_t)(sign * (my_row[j] -
+                                                     opp_row[j]));
+                        theirs[j] += (int16_t)(sign * (opp_row[j] -
+                                                       my_row[j]));
+                }
+        }
+}
+
+/* The second layer's sums, z2[k] = b2[k] + sum of w2[k][j] * hidden1[j]. */
+static void network_layer2_scalar(const othello_network_t *net,
+                                  const int16_t *acc, int32_t *z2)
+{
+        int16_t hidden1[NET_HIDDEN1];
+        int j, k;
+
+        for (j = 0; j < NET_HIDDEN1; j++) {
+                hidden1[j] = acc[j] < 0 ? 0 : acc[j] > NET_ONE ? NET_ONE :
+                             acc[j];
+        }
+        for (k = 0; k < NET_HIDDEN2; k++) {
+                z2[k] = net->b2[k];
+                for (j = 0; j < NET_HIDDEN1; j++) {
+                        z2[k] += hidden1[j] * net->w2[k][j];
+                }
+        }
+}
+
+#ifdef HAVE_X86_SIMD
+static void network_layer2_sse2(const othello_network_t *net,
+                                const int16_t *acc, int32_t *z2)
+{
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i one = _mm_set1_epi16(NET_ONE);
+        __m128i hidden1[NET_HIDDEN1 / 8], sum;
+        int j, k;
+
+        for (j = 0; j < NET_HIDDEN1 / 8; j++) {
+                hidden1[j] = _mm_loadu_si128((const __m128i *)&acc[j * 8]);
+                hidden1[j] = _mm_min_epi16(_mm_max_epi16(hidden1[j], zero),
+                                           one);
+        }
+        for (k = 0; k < NET_HIDDEN2; k++) {
+                sum = zero;
+                for (j = 0; j < NET_HIDDEN1 / 8; j++) {
+                        sum = _mm_add_epi32(sum, _mm_madd_epi16(hidden1[j],
+                                _mm_loadu_si128((const __m128i *)
+                                                &net->w2[k][j * 8])));
+                }
+                sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+                sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+                z2[k] = net->b2[k] + _mm_cvtsi128_si32(sum);
+        }
+}
+
+__attribute__((target("avx2")))
+static void network_layer2_avx2(const othello_network_t *net,
+                                const int16_t *acc, int32_t *z2)
+{
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i one = _mm256_set1_epi16(NET_ONE);
+        __m256i hidden1[NET_HIDDEN1 / 16], sum;
+        __m128i half;
+        int j, k;
+
+        for (j = 0; j < NET_HIDDEN1 / 16; j++) {
+                hidden1[j] = _mm256_loadu_si256((const __m256i *)
+                                                &acc[j * 16]);
+                hidden1[j] = _mm256_min_epi16(_mm256_max_epi16(hidden1[j],
+                                                               zero), one);
+        }
+        for (k = 0; k < NET_HIDDEN2; k++) {
+                sum = zero;
+                for (j = 0; j < NET_HIDDEN1 / 16; j++) {
+                        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(
+                                hidden1[j], _mm256_loadu_si256(
+                                        (const __m256i *)&net->w2[k][j * 16])));
+                }
+                half = _mm_add_epi32(_mm256_castsi256_si128(sum),
+                                     _mm256_extracti128_si256(sum, 1));
+                half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0x4E));
+                half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0xB1));
+                z2[k] = net->b2[k] + _mm_cvtsi128_si32(half);
+        }
+}
+#endif
+
+static int network_output(const othello_network_t *net, const int16_t *acc,
+                          othello_simd_t impl)
+{
+        int32_t z2[NET_HIDDEN2], out, hidden2;
+        int k;
+
+        switch (impl) {
+#ifdef HAVE_X86_SIMD
+        case OTHELLO_SIMD_DEFAULT:
+                if (__builtin_cpu_supports("avx2")) {
+                        network_layer2_avx2(net, acc, z2);
+                } else {
+                        network_layer2_sse2(net, acc, z2);
+                }
+                break;
+        case OTHELLO_SIMD_SSE2:
+                network_layer2_sse2(net, acc, z2);
+                break;
+        case OTHELLO_SIMD_AVX2:
+                network_layer2_avx2(net, acc, z2);
+                break;
+#endif
+        default:
+                network_layer2_scalar(net, acc, z2);
+                break;
+        }
+
+        out = net->b3;
+        for (k = 0; k < NET_HIDDEN2; k++) {
+                hidden2 = z2[k] <= 0 ? 0 : z2[k] / NET_ONE;
+                hidden2 = hidden2 > NET_ONE ? NET_ONE : hidden2;
+                out += hidden2 * net->w3[k];
+        }
+
+        return clamp_eval(out / NET_ONE);
+}
+
+/* Evaluate with the given accumulator for the side to move, or compute it
+   if acc is NULL. */
+static int network_eval(uint64_t my_disks, uint64_t opp_disks,
+                        const int16_t *acc)
+{
+        int16_t fresh[NET_HIDDEN1];
+
+        if (acc == NULL) {
+                network_refresh(network, my_disks, opp_disks, fresh);
+                acc = fresh;
+        }
+#ifdef OTHELLO_CHECK_INCREMENTAL
+        else {
+                int j;
+
+                network_refresh(network, my_disks, opp_disks, fresh);
+                for (j = 0; j < NET_HIDDEN1; j++) {
+                        if (acc[j] != fresh[j]) {
+                                fprintf(stderr, "accumulator %d: %d, "
+                                        "expected %d\n", j, acc[j], fresh[j]);
+                                abort();
+                        }
+                }
+        }
+#endif
+
+        return network_output(network, acc, OTHELLO_SIMD_DEFAULT);
+}
+
+bool othello_load_network(const char *path)
+{
+        const network_header_t *header;
+        const void *map;
+        size_t size = 0;
+
+        assert(sizeof(network_header_t) == 24);
+
+        map = map_file(path, &size);
+        if (map == NULL) {
+                return false;
+        }
+
+        header = map;
+        if (size != sizeof(*header) + sizeof(othello_network_t) ||
+            memcmp(header->magic, NETWORK_MAGIC, 8) != 0 ||
+            header->version != NETWORK_VERSION ||
+            header->inputs != NET_INPUTS || header->hidden1 != NET_HIDDEN1 ||
+            header->hidden2 != NET_HIDDEN2) {
+                unmap_file(map, size);
+                return false;
+        }
+
+        othello_unload_network();
+        network_map = map;
+        network_map_size = size;
+        network = (const othello_network_t *)(header + 1);
+        evaluator = OTHELLO_EVAL_NETWORK;
+
+        return true;
+}
+
+void othello_unload_network(void)
+{
+        if (network_map != NULL) {
+                unmap_file(network_map, network_map_size);
+        }
+        network = NULL;
+        network_map = NULL;
+        network_map_size = 0;
+        if (evaluator == OTHELLO_EVAL_NETWORK) {
+                evaluator = OTHELLO_EVAL_BUILTIN;
+        }
+}
+
+bool othello_save_network(const char *path, const othello_network_t *net)
+{
+        network_header_t header;
+        FILE *f;
+        bool ok;
+
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, NETWORK_MAGIC, sizeof(header.magic));
+        header.version = NETWORK_VERSION;
+        header.inputs = NET_INPUTS;
+        header.hidden1 = NET_HIDDEN1;
+        header.hidden2 = NET_HIDDEN2;
+
+        f = fopen(path, "wb");
+        if (f == NULL) {
+                return false;
+        }
+        ok = fwrite(&header, sizeof(header), 1, f) == 1 &&
+             fwrite(net, sizeof(*net), 1, f) == 1;
+
+        return fclose(f) == 0 && ok;
+}
+
+bool othello_network_eval(const othello_t *o, player_t p, othello_simd_t impl,
+                          int *score)
+{
+        int16_t acc[NET_HIDDEN1];
+
+        if (network == NULL) {
+                return false;
+        }
+#ifdef HAVE_X86_SIMD
+        if (impl == OTHELLO_SIMD_AVX2 && !__builtin_cpu_supports("avx2")) {
+                return false;
+        }
+#else
+        if (impl == OTHELLO_SIMD_SSE2 || impl == OTHELLO_SIMD_AVX2) {
+                return false;
+        }
+#endif
+
+        network_refresh(network, o->disks[p], o->disks[p ^ 1], acc);
+        *score = network_output(network, acc, impl);
+
+        return true;
+}
+
+bool othello_set_evaluator(othello_evaluator_t e)
+{
+        if ((e == OTHELLO_EVAL_PATTERNS && weights == NULL) ||
+            (e == OTHELLO_EVAL_NETWORK && network == NULL)) {
+                return false;
+        }
+        evaluator = e;
+
+        return true;
+}
+
+/* The evaluation function's state for the position being searched, seen
+   from both sides, kept up to date as moves are made and unmade so that
+   evaluation only needs the remaining table lookups or layers. */
+typedef struct {
+        othello_evaluator_t evaluator;
+        bool incremental;       /* The state below is kept up to date. */
+        int side;               /* Index of the state for the side to move. */
+        uint16_t codes[2][NUM_PATTERNS];
+        int16_t acc[2][NET_HIDDEN1];
+} eval_state_t;
+
+static void eval_state_init(eval_state_t *es, othello_evaluator_t e,
+                            bool incremental, uint64_t my_disks,
+                            uint64_t opp_disks)
+{
+        int i;
+
+        es->evaluator = e;
+        es->incremental = incremental;
+        es->side = 0;
+        if (!incremental) {
+                return;
+        }
+
+        switch (es->evaluator) {
+        case OTHELLO_EVAL_PATTERNS:
+                for (i = 0; i < NUM_PATTERNS; i++) {
+                        es->codes[0][i] = (uint16_t)pattern_code(my_disks,
+                                opp_disks, &PATTERNS[i]);
+                        es->codes[1][i] = (uint16_t)pattern_code(opp_disks,
+                                my_disks, &PATTERNS[i]);
+                }
+                break;
+        case OTHELLO_EVAL_NETWORK:
+                network_refresh(network, my_disks, opp_disks, es->acc[0]);
+                network_refresh(network, opp_disks, my_disks, es->acc[1]);
+                break;
+        default:
+                break;
+        }
+}
+
+/* Apply (sign 1) or take back (sign -1) a move by the side to move. */
+static void eval_state_update(eval_state_t *es, int sign, int move_idx,
+                              uint64_t flipped)
+{
+        int me = es->side, them = es->side ^ 1;
+
+        if (!es->incremental) {
+                return;
+        }
+
+        switch (es->evaluator) {
+        case OTHELLO_EVAL_PATTERNS:
+                pattern_update(es->codes[me], es->codes[them], sign, move_idx,
+                               flipped);
+                break;
+        case OTHELLO_EVAL_NETWORK:
+                network_update(network, es->acc[me], es->acc[them], sign,
+                               move_idx, flipped);
+                break;
+        default:
+                break;
+        }
+}
+
+static void eval_make_move(eval_state_t *es, int move_idx, uint64_t flipped)
+{
+        eval_state_update(es, 1, move_idx, flipped);
+        es->side ^= 1;
+}
+
+static void eval_unmake_move(eval_state_t *es, int move_idx, uint64_t flipped)
+{
+        es->side ^= 1;
+        eval_state_update(es, -1, move_idx, flipped);
+}
+
+static void eval_pass(eval_state_t *es)
+{
+        es->side ^= 1;
+}
+
+/* Evaluate the position for the side to move, with the evaluator and state
+   of es if non-NULL, or else the global evaluator. */
+static int eval(uint64_t my_disks, uint64_t opp_disks,
+                uint64_t my_moves, uint64_t opp_moves, const eval_state_t *es)
+{
+        static const uint64_t CORNER_MASK = 0x8100000000000081ULL;
+
+        othello_evaluator_t e = es != NULL ? es->evaluator : evaluator;
+        int my_disk_count, opp_disk_count;
+        uint64_t my_corners, opp_corners;
+        uint64_t my_frontier, opp_frontier;
+        uint64_t my_stable, opp_stable;
+        int score = 0;
+
+        if (!my_moves && !opp_moves) {
+                /* Terminal state. */
+                my_disk_count = popcount(my_disks);
+                opp_disk_count = popcount(opp_disks);
+                return (my_disk_count - opp_disk_count) * WIN_BONUS;
+        }
+
+        if (es != NULL && !es->incremental) {
+                es = NULL;
+        }
+        switch (e) {
+        case OTHELLO_EVAL_PATTERNS:
+                return pattern_eval(my_disks, opp_disks,
+                                    es ? es->codes[es->side] : NULL);
+        case OTHELLO_EVAL_NETWORK:
+                return network_eval(my_disks, opp_disks,
+                                    es ? es->acc[es->side] : NULL);
+        default:
+                break;
+        }
+
+        my_corners = my_disks & CORNER_MASK;
+        opp_corners = opp_disks & CORNER_MASK;
+
+        frontier_disks(my_disks, opp_disks, &my_frontier, &opp_frontier);
+        my_stable = opp_stable = 0;
+        if ((my_disks | opp_disks) & CORNER_MASK) {
+                /* Without corners, disks are only stable in rare cases
+                   where lines in all four directions are full. */
+                my_stable = stable_disks(my_disks, ~(my_disks | opp_disks));
+                opp_stable = stable_disks(opp_disks, ~(my_disks | opp_disks));
+        }
+
+        /* Optimize for corners, stable disks, mobility and few frontier
+           disks. */
+        score += (popcount(my_corners) - popcount(opp_corners)) * 16;
+        score += (popcount(my_stable) - popcount(opp_stable)) * 4;
+        score += (popcount(my_moves) - popcount(opp_moves)) * 2;
+        score += (popcount(my_frontier) - popcount(opp_frontier)) * -1;
+
+        assert(abs(score) < WIN_BONUS);
+
+        return score;
+}
+
+int othello_eval(const othello_t *o, player_t p)
+{
+        uint64_t my_disks, opp_disks, my_moves, opp_moves;
+
+        my_disks = o->disks[p];
+        opp_disks = o->disks[p ^ 1];
+        my_moves = generate_moves(my_disks, opp_disks);
+        opp_moves = generate_moves(opp_disks, my_disks);
+
+        return eval(my_disks, opp_disks, my_moves, opp_moves, NULL);
+}
+
+/* Transposition tables. Threads share them without locking: an entry
+   holds its data and the position's key xor the data, so an entry torn by
+   writes from two threads matches no key and is ignored. The two words are
+   read and written once each. */
+
+#ifdef __GNUC__
+#define CACHE_ALIGNED __attribute__((aligned(64)))
+#elif defined(_MSC_VER)
+#define CACHE_ALIGNED __declspec(align(64))
+#else
+#define CACHE_ALIGNED
+#endif
+
+#define TT_BITS 17              /* Entries in the global table. */
+#define TT_SIZE (1 << TT_BITS)
+#define TT_CLUSTER_SIZE 4       /* Entries per cache line. */
+
+typedef enum {
+        BOUND_EXACT,
+        BOUND_LOWER,    /* Score is at least the stored value. */
+        BOUND_UPPER     /* Score is at most the stored value. */
+} bound_t;
+
+typedef struct {
+        ATOMIC(uint64_t) check; /* Key xor data. */
+        ATOMIC(uint64_t) data;
+} tt_entry_t;
+
+/* The entries a position can be stored in: the first ones keep the deepest
+   results of the current search, the last one is always replaced. */
+typedef struct CACHE_ALIGNED {
+        tt_entry_t entries[TT_CLUSTER_SIZE];
+} tt_cluster_t;
+
+typedef struct {
+        tt_cluster_t *clusters;
+        size_t mask;            /* Clusters - 1. */
+        ATOMIC(uint8_t) generation; /* Of the current move; never 0. */
+} tt_t;
+
+/* An entry's data, unpacked. */
+typedef struct {
+        int score;
+        int depth;
+        int bound;
+        int best_move;          /* -1 if none. */
+        int generation;
+} tt_data_t;
+
+static uint64_t tt_pack(const tt_data_t *d)
+{
+        return (uint64_t)(uint32_t)d->score |
+               (uint64_t)(uint8_t)d->depth << 32 |
+               (uint64_t)(uint8_t)d->bound << 40 |
+               (uint64_t)(uint8_t)d->best_move << 48 |
+               (uint64_t)(uint8_t)d->generation << 56;
+}
+
+static void tt_unpack(uint64_t data, tt_data_t *d)
+{
+        d->score = (int32_t)(uint32_t)data;
+        d->depth = (uint8_t)(data >> 32);
+        d->bound = (uint8_t)(data >> 40);
+        d->best_move = (int8_t)(data >> 48);
+        d->generation = (uint8_t)(data >> 56);
+}
+
+/* Read an entry, returning false if it is not for key. */
+static bool tt_read(tt_entry_t *e, uint64_t key, tt_data_t *d)
+{
+        uint64_t check = load_relaxed(&e->check);
+        uint64_t data = load_relaxed(&e->data);
+
+        if ((check ^ data) != key) {
+                return false;
+        }
+        tt_unpack(data, d);
+
+        return true;
+}
+
+static void tt_write(tt_entry_t *e, uint64_t key, const tt_data_t *d)
+{
+        uint64_t data = tt_pack(d);
+
+        store_relaxed(&e->check, key ^ data);
+        store_relaxed(&e->data, data);
+}
+
+static bool tt_probe(const tt_t *tt, uint64_t key, tt_data_t *d)
+{
+        tt_cluster_t *c = &tt->clusters[key & tt->mask];
+        int i;
+
+        for (i = 0; i < TT_CLUSTER_SIZE; i++) {
+                if (tt_read(&c->entries[i], key, d)) {
+                        return true;
+                }
+        }
+
+        return false;
+}
+
+/* Store d for key, over the entry already for it if d is at least as deep,
+   or else over the shallowest or oldest of the depth-preferred entries if
+   d is at least as deep, or else over the last entry. d->generation must
+   be the table's. */
+static void tt_store(tt_t *tt, uint64_t key, const tt_data_t *d)
+{
+        tt_cluster_t *c = &tt->clusters[key & tt->mask];
+        tt_data_t old;
+        int i, victim = -1, depth, victim_depth = INT_MAX;
+
+        for (i = 0; i < TT_CLUSTER_SIZE; i++) {
+                if (tt_read(&c->entries[i], key, &old)) {
+                        if (d->depth >= old.depth ||
+                            old.generation != d->generation) {
+                                tt_write(&c->entries[i], key, d);
+                        }
+                        return;
+                }
+        }
+
+        for (i = 0; i < TT_CLUSTER_SIZE - 1; i++) {
+                tt_unpack(load_relaxed(&c->entries[i].data), &old);
+                depth = old.generation == d->generation ? old.depth : -1;
+                if (depth < victim_depth) {
+                        victim = i;
+                        victim_depth = depth;
+                }
+        }
+        if (d->depth < victim_depth) {
+                victim = TT_CLUSTER_SIZE - 1;
+        }
+        tt_write(&c->entries[victim], key, d);
+}
+
+/* Start a new generation once a move has been chosen, so entries from the
+   searches for it give way to those for the next move, including any
+   pondering on it. Searches that race to do so may skip one; either way,
+   the generation moves on. */
+static void tt_new_generation(tt_t *tt)
+{
+        uint8_t generation = (uint8_t)(load_relaxed(&tt->generation) + 1);
+
+        store_relaxed(&tt->generation, generation != 0 ? generation : 1);
+}
+
+/* The global transposition table. Scores only depend on the disks, not on
+   the path, so entries stay valid across searches and are not cleared
+   between moves. */
+static tt_cluster_t default_clusters[TT_SIZE / TT_CLUSTER_SIZE];
+static tt_t default_tt = { default_clusters, TT_SIZE / TT_CLUSTER_SIZE - 1,
+                           1 };
+
+/* The endgame solver's table, with exact score bounds, one entry per
+   position. */
+
+#define EG_TT_BITS 16
+#define EG_TT_SIZE (1 << EG_TT_BITS)
+
+typedef tt_entry_t eg_entry_t;
+
+static eg_entry_t eg_tt[EG_TT_SIZE];
+
+/* Read the bounds and best move stored for key, returning false if there
+   are none. */
+static bool eg_read(eg_entry_t *e, uint64_t key, int *lower, int *upper,
+                    int *best_move)
+{
+        uint64_t check = load_relaxed(&e->check);
+        uint64_t data = load_relaxed(&e->data);
+
+        if ((check ^ data) != key) {
+                return false;
+        }
+        *lower = (int8_t)data;
+        *upper = (int8_t)(data >> 8);
+        *best_move = (int8_t)(data >> 16);
+
+        return true;
+}
+
+static void eg_write(eg_entry_t *e, uint64_t key, int lower, int upper,
+                     int best_move)
+{
+        uint64_t data = (uint64_t)(uint8_t)lower |
+                        (uint64_t)(uint8_t)upper << 8 |
+                        (uint64_t)(uint8_t)best_move << 16;
+
+        store_relaxed(&e->check, key ^ data);
+        store_relaxed(&e->data, data);
+}
+
+/* Random keys for each byte value at each byte position of the two
+   bitboards; the hash of a position is the xor of sixteen of these. */
+static uint64_t zobrist[16][256];
+static bool zobrist_initialized;
+
+static uint64_t splitmix64(uint64_t *state)
+{
+        uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+}
+
+static void init_zobrist(void)
+{
+        uint64_t state = 0;
+        int i, j;
+
+        if (zobrist_initialized) {
+                return;
+        }
+
+        for (i = 0; i < 16; i++) {
+                for (j = 0; j < 256; j++) {
+                        zobrist[i][j] = splitmix64(&state);
+                }
+        }
+
+        zobrist_initialized = true;
+}
+
+static uint64_t hash_disks(uint64_t my_disks, uint64_t opp_disks)
+{
+        uint64_t h = 0;
+        int i;
+
+        assert(zobrist_initialized);
+
+        for (i = 0; i < 8; i++) {
+                h ^= zobrist[i][(my_disks >> (i * 8)) & 0xFF];
+                h ^= zobrist[i + 8][(opp_disks >> (i * 8)) & 0xFF];
+        }
+
+        return h;
+}
+
+/* Monotonic time in nanoseconds. */
+static uint64_t clock_ns(void)
+{
+#ifdef _WIN32
+        LARGE_INTEGER count, freq;
+
+        QueryPerformanceCounter(&count);
+        QueryPerformanceFrequency(&freq);
+
+        return (uint64_t)(count.QuadPart / freq.QuadPart * 1000000000 +
+                          count.QuadPart % freq.QuadPart * 1000000000 /
+                          freq.QuadPart);
+#else
+        struct timespec ts;
+
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+
+        return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+#define CLOCK_CHECK_NODES 4096  /* Nodes searched between clock checks. */
+
+typedef struct split split_t;
+typedef struct pool pool_t;
+typedef struct book book_t;
+
+typedef struct {
+        int features;           /* OTHELLO_SEARCH_* flags. */
+        othello_evaluator_t evaluator;
+        tt_t *tt;
+        uint8_t generation;     /* Of tt, when the search started. */
+        eg_entry_t *eg_tt;      /* EG_TT_SIZE entries. */
+        const book_t *book;
+        int eval_count;
+        int eval_limit;         /* If non-zero, abort at this eval_count. */
+        uint64_t nodes;
+        uint64_t tt_probes;
+        uint64_t tt_hits;
+        othello_stop_t *stop;   /* If non-NULL, abort when set. */
+        uint64_t deadline;      /* If non-zero, clock_ns() to abort at. */
+        uint64_t next_clock_check;
+        uint64_t start_time;    /* clock_ns() when the search started. */
+        int ply;                /* Moves and passes from the root. */
+        int seldepth;
+        int score;              /* Result of the last completed search. */
+        bool solved;            /* The score is a final disk difference. */
+        uint64_t cutoffs[OTHELLO_MAX_PLY];
+        uint64_t first_cutoffs[OTHELLO_MAX_PLY];
+        int pv[OTHELLO_MAX_PLY][OTHELLO_MAX_PLY]; /* Best line from each ply
+                                                      of the current path. */
+        int pv_length[OTHELLO_MAX_PLY];
+        int root_pv[OTHELLO_MAX_PLY];   /* From the last completed search. */
+        int root_pv_length;
+        bool aborted;           /* The search was stopped; ignore results. */
+        pool_t *pool;           /* Threads for splitting the search, or NULL. */
+        split_t *split;         /* Innermost split point being searched. */
+        eval_state_t eval_state;
+} search_t;
+
+static void search_init(search_t *s, othello_engine_t *engine,
+                        int features);
+static void search_init_from(search_t *s, const search_t *from);
+
+typedef struct {
+        int idx;
+        int key;
+        uint64_t my_disks;      /* Disks after the move. */
+        uint64_t opp_disks;
+} move_t;
+
+/* Static move ordering priority for each square: corners first, then
+   ordinary squares, then C-squares (next to a corner on the edge) and last
+   X-squares (diagonally next to a corner). */
+static const int8_t SQUARE_CLASS[64] = {
+        3, 0, 2, 2, 2, 2, 0, 3,
+        0,-1, 2, 2, 2, 2,-1, 0,
+        2, 2, 2, 2, 2, 2, 2, 2,
+        2, 2, 2, 2, 2, 2, 2, 2,
+        2, 2, 2, 2, 2, 2, 2, 2,
+        2, 2, 2, 2, 2, 2, 2, 2,
+        0,-1, 2, 2, 2, 2,-1, 0,
+        3, 0, 2, 2, 2, 2, 0, 3
+};
+
+#define HASH_MOVE_KEY INT_MAX
+
+/* Generate and resolve the moves in my_moves, sorted so the most promising
+   come first. Returns the number of moves. */
+static int order_moves(const search_t *s, uint64_t my_disks,
+                       uint64_t opp_disks, uint64_t my_moves, int hash_move,
+                       int depth, move_t *moves)
+{
+        move_t m;
+        int i, j, n;
+
+        n = 0;
+        for (i = 0; i < 64; i++) {
+                if (!(my_moves & (1ULL << i))) {
+                        continue;
+                }
+                m.idx = i;
+                m.my_disks = my_disks;
+                m.opp_disks = opp_disks;
+                resolve_move(&m.my_disks, &m.opp_disks, i);
+
+                if (!(s->features & OTHELLO_SEARCH_ORDERING)) {
+                        m.key = i == hash_move ? HASH_MOVE_KEY : 0;
+                } else if (i == hash_move) {
+                        m.key = HASH_MOVE_KEY;
+                } else if (depth > 1) {
+                        /* Prefer moves that leave the opponent few replies;
+                           the class dominates. */
+                        m.key = SQUARE_CLASS[i] * 64 - popcount(
+                                generate_moves(m.opp_disks, m.my_disks));
+                } else {
+                        /* Children are leaves; keep ordering cheap. */
+                        m.key = SQUARE_CLASS[i] * 64;
+                }
+
+                /* Insertion sort; stable, so ties keep board order. */
+                for (j = n; j > 0 && moves[j - 1].key < m.key; j--) {
+                        moves[j] = moves[j - 1];
+                }
+                moves[j] = m;
+                n++;
+        }
+
+        return n;
+}
+
+#define SPLIT_MIN_DEPTH 4       /* Shallowest negamax depth to split at. */
+#define SPLIT_MIN_EMPTIES 12    /* Fewest empty cells to split solve() at. */
+
+/* A node whose remaining moves are shared between threads. */
+struct split {
+        split_t *parent;        /* The split point this one is below. */
+        bool solving;           /* Searching with solve() or negamax(). */
+        int depth;
+        const move_t *moves;
+        int n_moves;
+        int next;               /* The next move to be searched. */
+        int alpha;
+        int beta;
+        int best;
+        int best_idx;
+        int ply;
+        int workers;            /* Threads searching moves here. */
+        ATOMIC(int) cutoff;     /* Set on a beta cutoff. */
+};
+
+static bool can_split(const search_t *s);
+static bool split(search_t *s, bool solving, int depth, const move_t *moves,
+                  int n_moves, int alpha, int beta, int *best, int *best_idx);
+
+/* Check whether the search should be abandoned, because it was stopped or a
+   split point above it got a cutoff. */
+static bool should_abort(search_t *s)
+{
+        const split_t *sp;
+
+        if (s->stop != NULL && load_relaxed(STOP_FLAG(s->stop))) {
+                return true;
+        }
+        if (s->eval_limit != 0 && s->eval_count >= s->eval_limit) {
+                return true;
+        }
+        if (s->deadline != 0 && s->nodes >= s->next_clock_check) {
+                if (clock_ns() >= s->deadline) {
+                        return true;
+                }
+                s->next_clock_check = s->nodes + CLOCK_CHECK_NODES;
+        }
+        for (sp = s->split; sp != NULL; sp = sp->parent) {
+                if (load_relaxed(&sp->cutoff)) {
+                        return true;
+                }
+        }
+
+        return false;
+}
+
+/* Start the principal variation at the current ply with move_idx (-1 for a
+   pass), followed by the one from the next ply. */
+static void update_pv(search_t *s, int move_idx)
+{
+        int ply = s->ply, n;
+
+        if (ply + 1 >= OTHELLO_MAX_PLY) {
+                return;
+        }
+
+        n = s->pv_length[ply + 1];
+        n = n < OTHELLO_MAX_PLY - 1 ? n : OTHELLO_MAX_PLY - 1;
+        s->pv[ply][0] = move_idx;
+        memcpy(&s->pv[ply][1], s->pv[ply + 1], (size_t)n * sizeof(int));
+        s->pv_length[ply] = n + 1;
+}
+
+static void save_root_pv(search_t *s)
+{
+        s->root_pv_length = s->pv_length[0];
+        memcpy(s->root_pv, s->pv[0], sizeof(s->root_pv));
+}
+
+static void count_cutoff(search_t *s, int move_num)
+{
+        if (s->ply < OTHELLO_MAX_PLY) {
+                s->cutoffs[s->ply]++;
+                if (move_num == 0) {
+                        s->first_cutoffs[s->ply]++;
+                }
+        }
+}
+
+static int negamax(search_t *s, uint64_t my_disks, uint64_t opp_disks,
+                   int max_depth, int alpha, int beta, int *best_move);
+
+/* Multi-ProbCut. The deep score of a position is predicted from a shallow
+   one by linear regression, so if the shallow search shows the prediction
+   to be above beta, or below alpha, by more than PROBCUT_CONFIDENCE
+   standard deviations, the deep search would most likely fail the same way
+   and is skipped. */
+
+#define PROBCUT_CONFIDENCE 1.5
+
+/* Fitted for the built-in evaluation by othello_train probcut. */
+static const othello_probcut_t
+builtin_probcut[OTHELLO_PROBCUT_PHASES][OTHELLO_PROBCUT_MAX_DEPTH + 1] = {
+        { /* 1-10 empty cells. */
+                { 0, 0.000f, 0.000f, 0.000f },
+                { 0, 0.000f, 0.000f, 0.000f },
+                { 0, 0.000f, 0.000f, 0.000f },
+                { 1, 1.112f, -1.682f, 20.743f },
+                { 2, 1.104f, -0.932f, 20.755f },
+                { 2, 1.160f, 8.597f, 28.103f },
+                { 3, 1.159f, -15.898f, 25.121f },
+                { 3, 1.211f, -5.377f, 32.791f },
+                { 4, 1.158f, 2.312f, 36.003f },
+                { 4, 1.249f, 12.028f, 39.114f },
+                { 0, 0.000f, 0.000f, 0.000f },
+                { 0, 0.000f, 0.000f, 0.000f },
+                { 0, 0.000f, 0.000f, 0.000f },
+                { 0, 0.000f, 0.000f, 0.000f },
+                { 0, 0.000f, 0.000f, 0.000f }
+        },
+        { /* 11-20 empty cells. */
+                { 0, 0.000f, 0.000f, 0.000f },
+                { 0, 0.000f, 0.000f, 0.000f },
+                { 0, 0.000f, 0.000f, 0.000f },
+                { 1, 1.110f, -1.498f, 13.842f },
+                { 2, 1.111f, -1.750f, 13.146f },
+                { 2, 1.156f, 3.448f, 17.845f },
+                { 3, 1.160f, -6.861f, 16.514f },
+                { 3, 1.206f, -0.006f, 20.150f },
+                { 4, 1.191f, -1.093f, 21.646f },
+                { 4, 1.245f, 8.579f, 25.980f },
+                { 5, 1.252f, -8.229f, 27.411f },
+                { 5, 1.326f, 3.389f, 30.544f },
+                { 6, 1.316f, -1.811f, 32.856f },
+                { 0, 0.000f, 0.000f, 0.000f },
+                { 0, 0.000f, 0.000f, 0.000f }
+        },
+        { /* 21-30 empty cells. */
+                { 0, 0.000f, 0.000f, 0.000f },
+                { 0, 0.000f, 0.000f, 0.000f },
+                { 0, 0.000f, 0.000f, 0.000f },
+                { 1, 1.081f, -1.459f, 9.180f },
+                { 2, 1.073f, -1.118f, 7.570f },
+                { 2, 1.128f, 0.113f, 10.876f },
+                { 3, 1.141f, -2.418f, 11.291f },
+                { 3, 1.195f, -0.651f, 13.606f },
+                { 4, 1.185f, -1.059f, 13.823f },
+                { 4, 1.235f, 1.833f, 15.671f },
+                { 5, 1.229f, -2.918f, 14.900f },
+                { 5, 1.286f, 0.575f, 15.982f },
+                { 6, 1.287f, -1.604f, 15.360f },
+                { 0, 0.000f, 0.000f, 0.000f },
+                { 0, 0.000f, 0.000f, 0.000f }
+        },
+        { /* 31-40 empty cells. */
+                { 0, 0.000f, 0.000f, 0.000f },
+                { 0, 0.000f, 0.000f, 0.000f },
+                { 0, 0.000f, 0.000f, 0.000f },
+                { 1, 1.124f, -1.503f, 6.706f },
+                { 2, 1.096f, -0.344f, 5.812f },
+                { 2, 1.154f, 0.713f, 7.893f },
+                { 3, 1.176f, -0.563f, 6.157f },
+                { 3, 1.224f, 0.022f, 7.282f },
+                { 4, 1.209f, 0.964f, 7.280f },
+                { 4, 1.242f, 1.696f, 8.535f },
+                { 5, 1.233f, 0.008f, 7.610f },
+                { 5, 1.270f, 0.452f, 8.324f },
+                { 6, 1.254f, 0.628f, 7.686f },
+                { 0, 0.000f, 0.000f, 0.000f },
+                { 0, 0.000f, 0.000f, 0.000f }
+        },
+        { /* 41-50 empty cells. */
+                { 0, 0.000f, 0.000f, 0.000f },
+                { 0, 0.000f, 0.000f, 0.000f },
+                { 0, 0.000f, 0.000f, 0.000f },
+                { 1, 1.040f, -0.779f, 4.380f },
+                { 2, 1.070f, -0.471f, 4.159f },
+                { 2, 1.116f, 1.008f, 5.386f },
+                { 3, 1.147f, -1.900f, 5.099f },
+                { 3, 1.206f, -0.873f, 5.536f },
+                { 4, 1.184f, 0.935f, 4.474f },
+                { 4, 1.220f, 1.773f, 5.495f },
+                { 5, 1.193f, -0.441f, 4.669f },
+                { 5, 1.250f, 0.211f, 5.408f },
+                { 6, 1.235f, 1.271f, 5.671f },
+                { 0, 0.000f, 0.000f, 0.000f },
+                { 0, 0.000f, 0.000f, 0.000f }
+        },
+        { /* 51-60 empty cells. */
+                { 0, 0.000f, 0.000f, 0.000f },
+                { 0, 0.000f, 0.000f, 0.000f },
+                { 0, 0.000f, 0.000f, 0.000f },
+                { 1, 0.745f, 1.956f, 3.633f },
+                { 2, 0.800f, 0.263f, 3.592f },
+                { 2, 0.814f, 2.383f, 4.122f },
+                { 3, 1.022f, -2.764f, 3.109f },
+                { 3, 1.060f, -0.889f, 3.221f },
+                { 4, 1.005f, 0.386f, 2.828f },
+                { 4, 1.034f, 2.261f, 3.092f },
+                { 5, 1.045f, -1.676f, 2.564f },
+                { 5, 1.046f, 0.218f, 2.582f },
+                { 6, 1.070f, 0.475f, 2.460f },
+                { 0, 0.000f, 0.000f, 0.000f },
+                { 0, 0.000f, 0.000f, 0.000f }
+        }
+};
+
+static othello_probcut_t
+custom_probcut[OTHELLO_PROBCUT_PHASES][OTHELLO_PROBCUT_MAX_DEPTH + 1];
+static bool have_custom_probcut = false;
+
+void othello_set_probcut(
+        const othello_probcut_t table[][OTHELLO_PROBCUT_MAX_DEPTH + 1])
+{
+        if (table != NULL) {
+                memcpy(custom_probcut, table, sizeof(custom_probcut));
+        }
+        have_custom_probcut = table != NULL;
+}
+
+/* Check whether the node can be cut off at the given depth, and if so set
+   *score to the bound it fails at. */
+static bool probcut(search_t *s, uint64_t my_disks, uint64_t opp_disks,
+                    int depth, int alpha, int beta, int *score)
+{
+        const othello_probcut_t *pc;
+        double margin, x;
+        int phase, bound, v;
+        bool cut = false;
+
+        if (depth > OTHELLO_PROBCUT_MAX_DEPTH || alpha <= -WIN_BONUS ||
+            beta >= WIN_BONUS) {
+                return false;
+        }
+
+        phase = (63 - popcount(my_disks | opp_disks)) / 10;
+        if (have_custom_probcut) {
+                pc = &custom_probcut[phase][depth];
+        } else if (s->evaluator == OTHELLO_EVAL_BUILTIN) {
+                pc = &builtin_probcut[phase][depth];
+        } else {
+                return false;
+        }
+        if (pc->depth <= 0 || pc->depth >= depth || pc->a <= 0) {
+                return false;
+        }
+        margin = PROBCUT_CONFIDENCE * pc->sigma;
+
+        /* The shallow score that predicts beta + margin, rounded up. */
+        x = (beta + margin - pc->b) / pc->a;
+        if (x < WIN_BONUS) {
+                bound = (int)x;
+                bound += bound < x;
+                v = negamax(s, my_disks, opp_disks, pc->depth, bound - 1,
+                            bound, NULL);
+                if (v >= bound) {
+                        *score = beta;
+                        cut = true;
+                }
+        }
+
+        /* And the one that predicts alpha - margin, rounded down. */
+        x = (alpha - margin - pc->b) / pc->a;
+        if (!cut && !s->aborted && x > -WIN_BONUS) {
+                bound = (int)x;
+                bound -= bound > x;
+                v = negamax(s, my_disks, opp_disks, pc->depth, bound,
+                            bound + 1, NULL);
+                if (v <= bound) {
+                        *score = alpha;
+                        cut = true;
+                }
+        }
+
+        /* The shallow searches started from this ply too. */
+        if (s->ply < OTHELLO_MAX_PLY) {
+                s->pv_length[s->ply] = 0;
+        }
+
+        return cut;
+}
+
+static int negamax(search_t *s, uint64_t my_disks, uint64_t opp_disks,
+                   int max_depth, int alpha, int beta, int *best_move)
+{
+        uint64_t my_moves, opp_moves, flipped;
+        uint64_t key = 0;
+        tt_data_t d;
+        move_t moves[64];
+        int i, n, v, best, best_idx, orig_alpha, hash_move;
+        bool found = false;
+
+        if (should_abort(s)) {
+                s->aborted = true;
+                return 0;
+        }
+
+        s->nodes++;
+        s->seldepth = s->ply > s->seldepth ? s->ply : s->seldepth;
+        if (s->ply < OTHELLO_MAX_PLY) {
+                s->pv_length[s->ply] = 0;
+        }
+
+        /* Generate moves. */
+        my_moves = generate_moves(my_disks, opp_disks);
+        opp_moves = generate_moves(opp_disks, my_disks);
+
+        if (!my_moves && opp_moves) {
+                /* Null move. */
+                eval_pass(&s->eval_state);
+                s->ply++;
+                v = -negamax(s, opp_disks, my_disks, max_depth, -beta,
+                             -alpha, best_move);
+                s->ply--;
+                eval_pass(&s->eval_state);
+                update_pv(s, -1);
+                return v;
+        }
+
+        if (max_depth == 0 || (!my_moves && !opp_moves)) {
+                /* Maximum depth or terminal state reached. */
+                ++s->eval_count;
+                return eval(my_disks, opp_disks, my_moves, opp_moves,
+                            &s->eval_state);
+        }
+
+        assert(alpha < beta);
+        orig_alpha = alpha;
+        hash_move = -1;
+
+        if (s->features & OTHELLO_SEARCH_HASH) {
+                key = hash_disks(my_disks, opp_disks);
+                s->tt_probes++;
+                found = tt_probe(s->tt, key, &d);
+
+                if (found) {
+                        hash_move = d.best_move;
+                }
+
+                /* At the root, the caller needs a move, so always search. */
+                if (found && d.depth >= max_depth && !best_move) {
+                        s->tt_hits++;
+                        if (d.bound == BOUND_EXACT ||
+                            (d.bound == BOUND_LOWER && d.score >= beta) ||
+                            (d.bound == BOUND_UPPER && d.score <= alpha)) {
+                                return d.score;
+                        }
+                }
+        }
+
+        /* The root is always searched, to find a move. */
+        if ((s->features & OTHELLO_SEARCH_PROBCUT) && !best_move &&
+            probcut(s, my_disks, opp_disks, max_depth, alpha, beta, &v)) {
+                return s->aborted ? 0 : v;
+        }
+
+        /* Find the best move. */
+        n = order_moves(s, my_disks, opp_disks, my_moves, hash_move,
+                        max_depth, moves);
+        best = -INT_MAX;
+        best_idx = -1;
+        for (i = 0; i < n; i++) {
+                if (i > 0 && max_depth >= SPLIT_MIN_DEPTH && can_split(s) &&
+                    split(s, false, max_depth, &moves[i], n - i, alpha, beta,
+                          &best, &best_idx)) {
+                        /* The other moves were searched in parallel. */
+                        if (s->aborted) {
+                                return 0;
+                        }
+                        if (best_move) {
+                                *best_move = best_idx;
+                        }
+                        break;
+                }
+
+                flipped = opp_disks ^ moves[i].opp_disks;
+                eval_make_move(&s->eval_state, moves[i].idx, flipped);
+                s->ply++;
+
+                if (i == 0 || !(s->features & OTHELLO_SEARCH_PVS)) {
+                        v = -negamax(s, moves[i].opp_disks, moves[i].my_disks,
+                                     max_depth - 1, -beta, -alpha, NULL);
+                } else {
+                        /* Principal variation search: try to prove with a
+                           null window that the move is no better than the
+                           best so far, and re-search if that fails. */
+                        v = -negamax(s, moves[i].opp_disks, moves[i].my_disks,
+                                     max_depth - 1, -alpha - 1, -alpha, NULL);
+                        if (v > alpha && v < beta) {
+                                v = -negamax(s, moves[i].opp_disks,
+                                             moves[i].my_disks, max_depth - 1,
+                                             -beta, -alpha, NULL);
+                        }
+                }
+
+                s->ply--;
+                eval_unmake_move(&s->eval_state, moves[i].idx, flipped);
+
+                if (s->aborted) {
+                        return 0;
+                }
+
+                if (v > best) {
+                        best = v;
+                        best_idx = moves[i].idx;
+                        if (best_move) {
+                                *best_move = best_idx;
+                        }
+                        if (v > alpha) {
+                                alpha = v;
+                                update_pv(s, best_idx);
+                        }
+
+                        if (alpha >= beta) {
+                                count_cutoff(s, i);
+                                break;
+                        }
+                }
+        }
+
+        if (s->features & OTHELLO_SEARCH_HASH) {
+                d.score = best;
+                d.depth = max_depth;
+                d.bound = best <= orig_alpha ? BOUND_UPPER :
+                          best >= beta ? BOUND_LOWER : BOUND_EXACT;
+                d.best_move = best_idx;
+                d.generation = s->generation;
+                tt_store(s->tt, key, &d);
+        }
+
+        return best;
+}
+
+static void fill_info(const search_t *s, int depth, int move_idx,
+                      othello_search_info_t *info)
+{
+        if (!info) {
+                return;
+        }
+
+        memset(info, 0, sizeof(*info));
+        info->depth = depth;
+        info->seldepth = s->seldepth;
+        info->score = s->score;
+        if (s->solved) {
+                info->exact = true;
+        } else if (s->score >= WIN_BONUS || -s->score >= WIN_BONUS) {
+                /* The game's end was reached. */
+                info->score = s->score / WIN_BONUS;
+                info->exact = true;
+        }
+        if (s->root_pv_length > 0 && s->root_pv[0] == move_idx) {
+                info->pv_length = s->root_pv_length;
+                memcpy(info->pv, s->root_pv, sizeof(info->pv));
+        } else {
+                /* The variation was found by another thread. */
+                info->pv[0] = move_idx;
+                info->pv_length = 1;
+        }
+        info->time = (double)(clock_ns() - s->start_time) / 1e9;
+        info->nodes = s->nodes;
+        info->evals = (uint64_t)s->eval_count;
+        info->tt_probes = s->tt_probes;
+        info->tt_hits = s->tt_hits;
+        memcpy(info->cutoffs, s->cutoffs, sizeof(info->cutoffs));
+        memcpy(info->first_cutoffs, s->first_cutoffs,
+               sizeof(info->first_cutoffs));
+}
+
+int othello_negamax(const othello_t *o, player_t p, int depth)
+{
+        return othello_negamax_stats(o, p, depth, 0, NULL);
+}
+
+/* Search o to a fixed depth, filling in *info if it is non-NULL. */
+static int fixed_depth_search(search_t *s, const othello_t *o, player_t p,
+                              int depth, othello_search_info_t *info)
+{
+        int best_move, v;
+
+        s->start_time = clock_ns();
+        if (s->features & OTHELLO_SEARCH_HASH) {
+                init_zobrist();
+        }
+        eval_state_init(&s->eval_state, s->evaluator,
+                        s->features & OTHELLO_SEARCH_INCREMENTAL, o->disks[p],
+                        o->disks[p ^ 1]);
+
+        v = negamax(s, o->disks[p], o->disks[p ^ 1], depth, -INT_MAX,
+                    INT_MAX, &best_move);
+        s->score = v;
+        save_root_pv(s);
+        fill_info(s, depth, best_move, info);
+
+        return v;
+}
+
+int othello_negamax_stats(const othello_t *o, player_t p, int depth,
+                          int features, othello_search_info_t *info)
+{
+        search_t s;
+
+        search_init(&s, NULL, features);
+
+        return fixed_depth_search(&s, o, p, depth, info);
+}
+
+#define ASPIRATION_WINDOW 8
+
+/* Search with a window around the score guess, widening it on failure. */
+static int aspiration_search(search_t *s, uint64_t my_disks,
+                             uint64_t opp_disks, int depth, int guess,
+                             int *best_move)
+{
+        int alpha, beta, delta, v, move;
+
+        delta = ASPIRATION_WINDOW;
+        alpha = guess - delta;
+        beta = guess + delta;
+
+        while (true) {
+                move = -1;
+                v = negamax(s, my_disks, opp_disks, depth, alpha, beta, &move);
+
+                if (s->aborted || (v > alpha && v < beta)) {
+                        break;
+                }
+
+                /* The best move of a failed search can't be trusted, so
+                   search again with a wider window. */
+                delta *= 4;
+                if (v <= alpha) {
+                        alpha = delta < WIN_BONUS ? v - delta : -INT_MAX;
+                } else {
+                        beta = delta < WIN_BONUS ? v + delta : INT_MAX;
+                }
+        }
+
+        *best_move = move;
+
+        return v;
+}
+
+/* Search with increasing depth until the evaluation budget is used up, the
+   maximum depth is reached, or the search is stopped. With a deadline, also
+   stop when the next iteration is not expected to finish in time, assuming
+   it takes as much longer than the last one as the last one did than the one
+   before. Returns the best move of the deepest completed iteration. */
+static int iterative_negamax(search_t *s, uint64_t my_disks,
+                             uint64_t opp_disks, int start_depth,
+                             int max_depth, int eval_budget,
+                             int *depth_reached)
+{
+        uint64_t deadline = s->deadline, start = 0, elapsed, last = 0;
+        othello_stop_t *stop = s->stop;
+        int depth, best_move, move, v = 0, evals, last_evals = 0;
+
+        assert(start_depth > 0 && "At least one move must be explored.");
+
+        if (s->features & OTHELLO_SEARCH_HASH) {
+                init_zobrist();
+        }
+        eval_state_init(&s->eval_state, s->evaluator,
+                        s->features & OTHELLO_SEARCH_INCREMENTAL,
+                        my_disks, opp_disks);
+
+        /* Finish the first iteration whatever the time, or if stopped, so
+           there is a move to return. Only at depth 1 is that quick, so
+           start there if the search can be cut short. */
+        if (deadline != 0 || stop != NULL) {
+                start_depth = 1;
+        }
+        s->deadline = 0;
+        s->stop = NULL;
+
+        s->eval_count = 0;
+        best_move = -1;
+        for (depth = start_depth;
+             depth <= max_depth && s->eval_count < eval_budget; depth++) {
+                if (deadline != 0) {
+                        start = clock_ns();
+                }
+                evals = s->eval_count;
+                move = -1;
+                if (depth > start_depth &&
+                    (s->features & OTHELLO_SEARCH_ASPIRATION)) {
+                        v = aspiration_search(s, my_disks, opp_disks, depth, v,
+                                              &move);
+                } else {
+                        v = negamax(s, my_disks, opp_disks, depth, -INT_MAX,
+                                    INT_MAX, &move);
+                }
+                if (s->aborted) {
+                        break;
+                }
+                best_move = move;
+                *depth_reached = depth;
+                s->score = v;
+                s->solved = false;
+                save_root_pv(s);
+                if (v >= WIN_BONUS || -v >= WIN_BONUS) {
+                        break;
+                }
+
+                s->stop = stop;
+                if (deadline != 0) {
+                        s->deadline = deadline;
+                        elapsed = clock_ns() - start;
+                        if (last != 0 && start + elapsed +
+                            (double)elapsed * elapsed / last >
+                            (double)deadline) {
+                                break;
+                        }
+                        last = elapsed > 0 ? elapsed : 1;
+                }
+
+                /* Likewise for the budget. Iterations answered from the
+                   hash table cost little and predict little, so the limit
+                   also aborts the next iteration if it runs over. */
+                if (eval_budget != INT_MAX) {
+                        s->eval_limit = eval_budget;
+                        evals = s->eval_count - evals;
+                        if (last_evals != 0 && s->eval_count +
+                            (double)evals * evals / last_evals >
+                            (double)eval_budget) {
+                                break;
+                        }
+                        last_evals = evals > 0 ? evals : 1;
+                }
+        }
+        s->deadline = deadline;
+        s->stop = stop;
+        s->eval_limit = 0;
+
+        return best_move;
+}
+
+int othello_iterative_negamax(const othello_t *o, player_t p, int budget)
+{
+        search_t s;
+        int depth;
+
+        search_init(&s, NULL, OTHELLO_SEARCH_ALL);
+
+        return iterative_negamax(&s, o->disks[p], o->disks[p ^ 1], 1, INT_MAX,
+                                 budget, &depth);
+}
+
+/* Endgame solver. Scores are final disk differences. */
+
+#define EG_HASH_EMPTIES 7       /* Fewest empty cells to use the table for. */
+#define EG_FASTEST_FIRST 7      /* Fewest empty cells to order by mobility. */
+#define EG_MAX_SCORE 64
+
+void othello_clear_hash(void)
+{
+        /* Searches started afterwards can then run in parallel. */
+        init_zobrist();
+        memset(default_clusters, 0, sizeof(default_clusters));
+        memset(eg_tt, 0, sizeof(eg_tt));
+}
+
+static const uint64_t QUADRANT_MASKS[] = {
+        0x000000000F0F0F0FULL,
+        0x00000000F0F0F0F0ULL,
+        0x0F0F0F0F00000000ULL,
+        0xF0F0F0F000000000ULL
+};
+
+/* Empty cells in quadrants with an odd number of empty cells. The last move
+   in a region is an advantage, so moves there are tried first. */
+static uint64_t odd_regions(uint64_t empty_cells)
+{
+        uint64_t odd = 0;
+        int q;
+
+        for (q = 0; q < 4; q++) {
+                if (popcount(empty_cells & QUADRANT_MASKS[q]) & 1) {
+                        odd |= empty_cells & QUADRANT_MASKS[q];
+                }
+        }
+
+        return odd;
+}
+
+static int final_score(uint64_t my_disks, uint64_t opp_disks)
+{
+        return popcount(my_disks) - popcount(opp_disks);
+}
+
+/* Bound the final score by the disks that are already stable: if it cannot
+   be above alpha or below beta, store the bound in *score and return true.
+   Cheap checks on the disk counts skip positions where it cannot help. */
+static bool stability_cutoff(uint64_t my_disks, uint64_t opp_disks,
+                             int alpha, int beta, int *score)
+{
+        uint64_t empty_cells = ~(my_disks | opp_disks);
+        int bound;
+
+        if (64 - 2 * popcount(opp_disks) <= alpha) {
+                bound = 64 - 2 * popcount(stable_disks(opp_disks,
+                                                       empty_cells));
+                if (bound <= alpha) {
+                        *score = bound;
+                        return true;
+                }
+        }
+        if (2 * popcount(my_disks) - 64 >= beta) {
+                bound = 2 * popcount(stable_disks(my_disks, empty_cells)) - 64;
+                if (bound >= beta) {
+                        *score = bound;
+                        return true;
+                }
+        }
+
+        return false;
+}
+
+/* The last few empty cells are handled by specialized functions which try
+   the cells in x (in parity order) by computing flips directly, rather than
+   generating moves. passed is true if the opponent just passed. */
+
+static int solve_1(search_t *s, uint64_t my_disks, uint64_t opp_disks, int x)
+{
+        /* There are 63 disks on the board. */
+        int score = 2 * popcount(my_disks) - 63;
+        uint64_t f;
+
+        s->nodes++;
+
+        if ((f = flipped_disks(my_disks, opp_disks, x))) {
+                return score + 1 + 2 * popcount(f);
+        }
+        if ((f = flipped_disks(opp_disks, my_disks, x))) {
+                return score - 1 - 2 * popcount(f);
+        }
+
+        return score;
+}
+
+static int solve_2(search_t *s, uint64_t my_disks, uint64_t opp_disks,
+                   int alpha, int beta, const int *x, bool passed)
+{
+        uint64_t f;
+        int v, best = -INT_MAX;
+
+        s->nodes++;
+
+        if ((f = flipped_disks(my_disks, opp_disks, x[0]))) {
+                best = -solve_1(s, opp_disks ^ f,
+                                my_disks ^ f ^ (1ULL << x[0]), x[1]);
+                if (best >= beta) {
+                        return best;
+                }
+        }
+        if ((f = flipped_disks(my_disks, opp_disks, x[1]))) {
+                v = -solve_1(s, opp_disks ^ f,
+                             my_disks ^ f ^ (1ULL << x[1]), x[0]);
+                best = v > best ? v : best;
+        }
+
+        if (best == -INT_MAX) {
+                if (passed) {
+                        return final_score(my_disks, opp_disks);
+                }
+                return -solve_2(s, opp_disks, my_disks, -beta, -alpha, x,
+                                true);
+        }
+
+        return best;
+}
+
+static int solve_3(search_t *s, uint64_t my_disks, uint64_t opp_disks,
+                   int alpha, int beta, const int *x, bool passed)
+{
+        static const int REST[3][2] = { { 1, 2 }, { 0, 2 }, { 0, 1 } };
+
+        uint64_t f;
+        int i, v, rest[2], best = -INT_MAX;
+
+        s->nodes++;
+
+        for (i = 0; i < 3; i++) {
+                if (!(f = flipped_disks(my_disks, opp_disks, x[i]))) {
+                        continue;
+                }
+                rest[0] = x[REST[i][0]];
+                rest[1] = x[REST[i][1]];
+                v = -solve_2(s, opp_disks ^ f, my_disks ^ f ^ (1ULL << x[i]),
+                             -beta, -alpha, rest, false);
+                if (v > best) {
+                        best = v;
+                        alpha = v > alpha ? v : alpha;
+                        if (alpha >= beta) {
+                                return best;
+                        }
+                }
+        }
+
+        if (best == -INT_MAX) {
+                if (passed) {
+                        return final_score(my_disks, opp_disks);
+                }
+                return -solve_3(s, opp_disks, my_disks, -beta, -alpha, x,
+                                true);
+        }
+
+        return best;
+}
+
+static int solve_4(search_t *s, uint64_t my_disks, uint64_t opp_disks,
+                   int alpha, int beta, const int *x, bool passed)
+{
+        static const int REST[4][3] = {
+                { 1, 2, 3 }, { 0, 2, 3 }, { 0, 1, 3 }, { 0, 1, 2 }
+        };
+
+        uint64_t f;
+        int i, v, rest[3], best = -INT_MAX;
+
+        s->nodes++;
+
+        for (i = 0; i < 4; i++) {
+                if (!(f = flipped_disks(my_disks, opp_disks, x[i]))) {
+                        continue;
+                }
+                rest[0] = x[REST[i][0]];
+                rest[1] = x[REST[i][1]];
+                rest[2] = x[REST[i][2]];
+                v = -solve_3(s, opp_disks ^ f, my_disks ^ f ^ (1ULL << x[i]),
+                             -beta, -alpha, rest, false);
+                if (v > best) {
+                        best = v;
+                        alpha = v > alpha ? v : alpha;
+                        if (alpha >= beta) {
+                                return best;
+                        }
+                }
+        }
+
+        if (best == -INT_MAX) {
+                if (passed) {
+                        return final_score(my_disks, opp_disks);
+                }
+                return -solve_4(s, opp_disks, my_disks, -beta, -alpha, x,
+                                true);
+        }
+
+        return best;
+}
+
+static int solve_few(search_t *s, uint64_t my_disks, uint64_t opp_disks,
+                     int alpha, int beta)
+{
+        uint64_t empty_cells = ~(my_disks | opp_disks);
+        uint64_t odd = odd_regions(empty_cells);
+        int x[4], n = 0, i;
+
+        /* Cells in odd regions first. */
+        for (i = 0; i < 64; i++) {
+                if (odd & (1ULL << i)) {
+                        x[n++] = i;
+                }
+        }
+        for (i = 0; i < 64; i++) {
+                if ((empty_cells & ~odd) & (1ULL << i)) {
+                        x[n++] = i;
+                }
+        }
+
+        switch (n) {
+        case 0:
+                s->nodes++;
+                return final_score(my_disks, opp_disks);
+        case 1:
+                return solve_1(s, my_disks, opp_disks, x[0]);
+        case 2:
+                return solve_2(s, my_disks, opp_disks, alpha, beta, x, false);
+        case 3:
+                return solve_3(s, my_disks, opp_disks, alpha, beta, x, false);
+        default:
+                assert(n == 4);
+                return solve_4(s, my_disks, opp_disks, alpha, beta, x, false);
+        }
+}
+
+static int solve(search_t *s, uint64_t my_disks, uint64_t opp_disks,
+                 int alpha, int beta, int *best_move)
+{
+        uint64_t empty_cells = ~(my_disks | opp_disks);
+        uint64_t my_moves, odd, key = 0;
+        eg_entry_t *e = NULL;
+        move_t moves[64], m;
+        int n_empties, i, j, n, v, best, best_idx, hash_move, orig_alpha;
+        int lower = -EG_MAX_SCORE, upper = EG_MAX_SCORE;
+
+        n_empties = popcount(empty_cells);
+        if (s->ply + n_empties > s->seldepth) {
+                /* The first line searched from here reaches the end. */
+                s->seldepth = s->ply + n_empties;
+        }
+        if (s->ply < OTHELLO_MAX_PLY) {
+                /* The variation stops short of the last few moves. */
+                s->pv_length[s->ply] = 0;
+        }
+
+        if (n_empties <= 4 && !best_move) {
+                return solve_few(s, my_disks, opp_disks, alpha, beta);
+        }
+
+        if (should_abort(s)) {
+                s->aborted = true;
+                return 0;
+        }
+
+        s->nodes++;
+
+        my_moves = generate_moves(my_disks, opp_disks);
+        if (!my_moves) {
+                if (!generate_moves(opp_disks, my_disks)) {
+                        return final_score(my_disks, opp_disks);
+                }
+                s->ply++;
+                v = -solve(s, opp_disks, my_disks, -beta, -alpha, best_move);
+                s->ply--;
+                update_pv(s, -1);
+                return v;
+        }
+
+        hash_move = -1;
+        if (n_empties >= EG_HASH_EMPTIES) {
+                key = hash_disks(my_disks, opp_disks);
+                e = &s->eg_tt[key & (EG_TT_SIZE - 1)];
+                s->tt_probes++;
+
+                if (eg_read(e, key, &lower, &upper, &hash_move)) {
+                        s->tt_hits++;
+
+                        if (!best_move) {
+                                if (lower >= beta) {
+                                        return lower;
+                                }
+                                if (upper <= alpha) {
+                                        return upper;
+                                }
+                                if (lower == upper) {
+                                        return lower;
+                                }
+                                alpha = lower > alpha ? lower : alpha;
+                                beta = upper < beta ? upper : beta;
+                        }
+                }
+        }
+
+        if ((s->features & OTHELLO_SEARCH_STABILITY) && !best_move &&
+            stability_cutoff(my_disks, opp_disks, alpha, beta, &v)) {
+                return v;
+        }
+
+        orig_alpha = alpha;
+
+        /* Order the moves: hash move, then odd regions, then (far from the
+           end) the moves leaving the opponent fewest replies. */
+        odd = odd_regions(empty_cells);
+        n = 0;
+        for (i = 0; i < 64; i++) {
+                if (!(my_moves & (1ULL << i))) {
+                        continue;
+                }
+                m.idx = i;
+                m.my_disks = my_disks;
+                m.opp_disks = opp_disks;
+                resolve_move(&m.my_disks, &m.opp_disks, i);
+
+                if (i == hash_move) {
+                        m.key = HASH_MOVE_KEY;
+                } else {
+                        m.key = ((odd >> i) & 1) * 16 + SQUARE_CLASS[i];
+                        if (n_empties >= EG_FASTEST_FIRST) {
+                                m.key -= 64 * popcount(generate_moves(
+                                        m.opp_disks, m.my_disks));
+                        }
+                }
+
+                for (j = n; j > 0 && moves[j - 1].key < m.key; j--) {
+                        moves[j] = moves[j - 1];
+                }
+                moves[j] = m;
+                n++;
+        }
+
+        best = -INT_MAX;
+        best_idx = -1;
+        for (i = 0; i < n; i++) {
+                if (i > 0 && n_empties >= SPLIT_MIN_EMPTIES && can_split(s) &&
+                    split(s, true, n_empties, &moves[i], n - i, alpha, beta,
+                          &best, &best_idx)) {
+                        if (s->aborted) {
+                                return 0;
+                        }
+                        if (best_move) {
+                                *best_move = best_idx;
+                        }
+                        break;
+                }
+
+                s->ply++;
+                if (i == 0) {
+                        v = -solve(s, moves[i].opp_disks, moves[i].my_disks,
+                                   -beta, -alpha, NULL);
+                } else {
+                        v = -solve(s, moves[i].opp_disks, moves[i].my_disks,
+                                   -alpha - 1, -alpha, NULL);
+                        if (v > alpha && v < beta) {
+                                v = -solve(s, moves[i].opp_disks,
+                                           moves[i].my_disks, -beta, -alpha,
+                                           NULL);
+                        }
+                }
+                s->ply--;
+
+                if (s->aborted) {
+                        return 0;
+                }
+
+                if (v > best) {
+                        best = v;
+                        best_idx = moves[i].idx;
+                        if (best_move) {
+                                *best_move = best_idx;
+                        }
+                        if (v > alpha) {
+                                update_pv(s, best_idx);
+                                if (v >= beta) {
+                                        count_cutoff(s, i);
+                                        break;
+                                }
+                                alpha = v;
+                        }
+                }
+        }
+
+        if (e != NULL) {
+                /* Narrow the bounds read above, if any. */
+                if (best < beta) {
+                        upper = best;
+                }
+                if (best > orig_alpha) {
+                        lower = best;
+                }
+                eg_write(e, key, lower, upper, best_idx);
+        }
+
+        return best;
+}
+
+static int endgame_empties = 18;
+
+void othello_set_endgame_empties(int empties)
+{
+        endgame_empties = empties;
+}
+
+static int solve_root(search_t *s, uint64_t my_disks, uint64_t opp_disks,
+                      othello_solve_mode_t mode, int *best_move)
+{
+        int v;
+
+        init_zobrist();
+
+        if (mode == OTHELLO_SOLVE_WLD) {
+                v = solve(s, my_disks, opp_disks, -1, 1, best_move);
+        } else {
+                v = solve(s, my_disks, opp_disks, -EG_MAX_SCORE - 1,
+                          EG_MAX_SCORE + 1, best_move);
+        }
+        if (!s->aborted) {
+                s->score = v;
+                s->solved = true;
+                save_root_pv(s);
+        }
+
+        return v;
+}
+
+int othello_solve(const othello_t *o, player_t p, othello_solve_mode_t mode,
+                  int *row, int *col)
+{
+        search_t s;
+        int move_idx = -1, v;
+
+        assert(othello_has_valid_move(o, p));
+
+        search_init(&s, NULL, OTHELLO_SEARCH_ALL);
+        v = solve_root(&s, o->disks[p], o->disks[p ^ 1], mode, &move_idx);
+
+        *row = move_idx / 8;
+        *col = move_idx % 8;
+
+        return v;
+}
+
+/* Opening book file layout: the header, followed by the entries sorted by
+   key, which is hash_disks() of the canonical form of the position. */
+
+#define BOOK_MAGIC "OTHEBOOK"
+#define BOOK_VERSION 1
+
+typedef struct {
+        char magic[8];
+        uint32_t version;
+        uint32_t reserved;
+        uint64_t entries;
+} book_header_t;
+
+typedef struct {
+        uint64_t key;
+        int16_t scores[OTHELLO_BOOK_MOVES];
+        int8_t moves[OTHELLO_BOOK_MOVES];  /* In the canonical form; -1 if
+                                              there are fewer. */
+        uint8_t depth;
+        uint8_t reserved[3];
+} book_entry_t;
+
+/* A mapped book file, and the positions added since, sorted by key. */
+struct book {
+        const void *map;
+        size_t map_size;
+        const book_entry_t *entries;
+        size_t size;
+        book_entry_t *added;
+        size_t added_size;
+        size_t added_capacity;
+};
+
+/* The book of the functions without an engine. */
+static book_t default_book;
+
+static void book_unload(book_t *b)
+{
+        if (b->map != NULL) {
+                unmap_file(b->map, b->map_size);
+        }
+        free(b->added);
+        memset(b, 0, sizeof(*b));
+}
+
+static bool book_load(book_t *b, const char *path)
+{
+        const book_header_t *header;
+        const void *map;
+        size_t size = 0;
+
+        assert(sizeof(book_header_t) == 24 && sizeof(book_entry_t) == 24);
+
+        map = map_file(path, &size);
+        if (map == NULL) {
+                return false;
+        }
+
+        header = map;
+        if (size < sizeof(*header) ||
+            memcmp(header->magic, BOOK_MAGIC, 8) != 0 ||
+            header->version != BOOK_VERSION ||
+            (size - sizeof(*header)) / sizeof(book_entry_t) !=
+            header->entries ||
+            (size - sizeof(*header)) % sizeof(book_entry_t) != 0) {
+                unmap_file(map, size);
+                return false;
+        }
+
+        book_unload(b);
+        b->map = map;
+        b->map_size = size;
+        b->entries = (const book_entry_t *)(header + 1);
+        b->size = (size_t)header->entries;
+
+        return true;
+}
+
+bool othello_load_book(const char *path)
+{
+        return book_load(&default_book, path);
+}
+
+void othello_unload_book(void)
+{
+        book_unload(&default_book);
+}
+
+/* Index of the first entry with a key not less than the given one. */
+static size_t book_search(const book_entry_t *entries, size_t n,
+                          uint64_t key)
+{
+        size_t lo = 0, hi = n, mid;
+
+        while (lo < hi) {
+                mid = lo + (hi - lo) / 2;
+                if (entries[mid].key < key) {
+                        lo = mid + 1;
+                } else {
+                        hi = mid;
+                }
+        }
+
+        return lo;
+}
+
+static uint64_t book_key(const othello_t *o, player_t p, int *t)
+{
+        uint64_t my_disks = o->disks[p], opp_disks = o->disks[p ^ 1];
+
+        init_zobrist();
+        *t = canonical_form(&my_disks, &opp_disks);
+
+        return hash_disks(my_disks, opp_disks);
+}
+
+static bool book_lookup(const book_t *b, const othello_t *o, player_t p,
+                        othello_book_moves_t *moves)
+{
+        const book_entry_t *e = NULL;
+        uint64_t key;
+        size_t i;
+        int t, j, move;
+
+        if (b->entries == NULL && b->added == NULL) {
+                return false;
+        }
+
+        key = book_key(o, p, &t);
+        i = book_search(b->added, b->added_size, key);
+        if (i < b->added_size && b->added[i].key == key) {
+                e = &b->added[i];
+        } else {
+                i = book_search(b->entries, b->size, key);
+                if (i < b->size && b->entries[i].key == key) {
+                        e = &b->entries[i];
+                }
+        }
+        if (e == NULL) {
+                return false;
+        }
+
+        moves->n_moves = 0;
+        moves->depth = e->depth;
+        for (j = 0; j < OTHELLO_BOOK_MOVES && e->moves[j] >= 0; j++) {
+                move = ctz(transform(1ULL << e->moves[j],
+                                     INVERSE_TRANSFORM[t]));
+                if (!othello_is_valid_move(o, p, move / 8, move % 8)) {
+                        /* Another position with the same key. */
+                        return false;
+                }
+                moves->moves[j] = move;
+                moves->scores[j] = e->scores[j];
+                moves->n_moves++;
+        }
+
+        return moves->n_moves > 0;
+}
+
+bool othello_book_lookup(const othello_t *o, player_t p,
+                         othello_book_moves_t *moves)
+{
+        return book_lookup(&default_book, o, p, moves);
+}
+
+bool othello_book_add(const othello_t *o, player_t p,
+                      const othello_book_moves_t *moves)
+{
+        book_t *b = &default_book;
+        book_entry_t e, *entries;
+        size_t i, capacity;
+        int t, j, score;
+
+        assert(moves->n_moves > 0 && moves->n_moves <= OTHELLO_BOOK_MOVES);
+
+        memset(&e, 0, sizeof(e));
+        e.key = book_key(o, p, &t);
+        e.depth = (uint8_t)(moves->depth < 0 ? 0 : moves->depth > 255 ? 255 :
+                            moves->depth);
+        for (j = 0; j < OTHELLO_BOOK_MOVES; j++) {
+                e.moves[j] = -1;
+                if (j < moves->n_moves) {
+                        e.moves[j] = (int8_t)ctz(transform(
+                                1ULL << moves->moves[j], t));
+                        score = moves->scores[j];
+                        e.scores[j] = (int16_t)(score > INT16_MAX ?
+                                INT16_MAX : score < -INT16_MAX ?
+                                -INT16_MAX : score);
+                }
+        }
+
+        i = book_search(b->added, b->added_size, e.key);
+        if (i < b->added_size && b->added[i].key == e.key) {
+                b->added[i] = e;
+                return true;
+        }
+
+        if (b->added_size == b->added_capacity) {
+                capacity = b->added_capacity ? 2 * b->added_capacity : 64;
+                entries = realloc(b->added, capacity * sizeof(*entries));
+                if (entries == NULL) {
+                        return false;
+                }
+                b->added = entries;
+                b->added_capacity = capacity;
+        }
+        memmove(&b->added[i + 1], &b->added[i],
+                (b->added_size - i) * sizeof(*b->added));
+        b->added[i] = e;
+        b->added_size++;
+
+        return true;
+}
+
+bool othello_save_book(const char *path)
+{
+        const book_t *b = &default_book;
+        book_header_t header;
+        book_entry_t *entries;
+        size_t i = 0, j = 0, n = 0;
+        char *tmp_path;
+        FILE *f;
+        bool ok;
+
+        /* Merge the added positions into the mapped ones, replacing those
+           with the same key. */
+        entries = malloc((b->size + b->added_size + 1) * sizeof(*entries));
+        if (entries == NULL) {
+                return false;
+        }
+        while (i < b->size || j < b->added_size) {
+                if (j == b->added_size ||
+                    (i < b->size &&
+                     b->entries[i].key < b->added[j].key)) {
+                        entries[n++] = b->entries[i++];
+                } else {
+                        if (i < b->size &&
+                            b->entries[i].key == b->added[j].key) {
+                                i++;
+                        }
+                        entries[n++] = b->added[j++];
+                }
+        }
+
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, BOOK_MAGIC, sizeof(header.magic));
+        header.version = BOOK_VERSION;
+        header.entries = n;
+
+        /* Write a temporary file first, so that a failure keeps both the
+           book and the file. */
+        tmp_path = malloc(strlen(path) + sizeof(".tmp"));
+        if (tmp_path == NULL) {
+                free(entries);
+                return false;
+        }
+        strcpy(tmp_path, path);
+        strcat(tmp_path, ".tmp");
+        f = fopen(tmp_path, "wb");
+        ok = f != NULL &&
+             fwrite(&header, sizeof(header), 1, f) == 1 &&
+             fwrite(entries, sizeof(*entries), n, f) == n;
+        ok = f != NULL && fclose(f) == 0 && ok;
+        free(entries);
+
+        if (ok) {
+                /* The file may be the mapped one. */
+                othello_unload_book();
+                ok = replace_file(tmp_path, path);
+        }
+        if (!ok) {
+                remove(tmp_path);
+        }
+        free(tmp_path);
+
+        return ok;
+}
+
+/* Play the book's best move for the position, if it has one. */
+static bool book_move(search_t *s, const othello_t *o, player_t p,
+                      int *move_idx, int *depth)
+{
+        othello_book_moves_t moves;
+
+        if (!(s->features & OTHELLO_SEARCH_BOOK) ||
+            !book_lookup(s->book, o, p, &moves)) {
+                return false;
+        }
+
+        *move_idx = moves.moves[0];
+        *depth = moves.depth;
+        s->score = moves.scores[0];
+        s->solved = false;
+
+        return true;
+}
+
+#define START_DEPTH 8
+#define EVAL_BUDGET 4000000
+
+void othello_compute_move(const othello_t *o, player_t p, int *row, int *col)
+{
+        othello_compute_move_stats(o, p, OTHELLO_SEARCH_ALL, row, col, NULL);
+}
+
+void othello_compute_move_stats(const othello_t *o, player_t p, int features,
+                                int *row, int *col, othello_search_info_t *info)
+{
+        othello_compute_move_stoppable(o, p, 0, features, NULL, row, col,
+                                       info);
+}
+
+void othello_compute_move_timed(const othello_t *o, player_t p, int ms,
+                                int features, int *row, int *col,
+                                othello_search_info_t *info)
+{
+        assert(ms > 0);
+
+        othello_compute_move_stoppable(o, p, ms, features, NULL, row, col,
+                                       info);
+}
+
+#define TIMED_SOLVE_DEPTH 4
+
+static int lazy_smp(search_t *s, uint64_t my_disks, uint64_t opp_disks,
+                    int threads, bool solving, othello_solve_mode_t mode,
+                    int start_depth, int max_depth, int eval_budget,
+                    int *depth_reached, int *score);
+
+/* Run iterative_negamax(), with Lazy SMP helpers if threads > 1. */
+static int run_iterative(search_t *s, uint64_t my_disks, uint64_t opp_disks,
+                         int threads, int start_depth, int max_depth,
+                         int eval_budget, int *depth_reached)
+{
+        int score;
+
+        if (threads > 1) {
+                return lazy_smp(s, my_disks, opp_disks, threads, false,
+                                OTHELLO_SOLVE_EXACT, start_depth, max_depth,
+                                eval_budget, depth_reached, &score);
+        }
+
+        return iterative_negamax(s, my_disks, opp_disks, start_depth,
+                                 max_depth, eval_budget, depth_reached);
+}
+
+/* Solve exactly, with Lazy SMP helpers if threads > 1. */
+static int run_solve(search_t *s, uint64_t my_disks, uint64_t opp_disks,
+                     int threads)
+{
+        int move_idx = -1, depth, score;
+
+        if (threads > 1) {
+                return lazy_smp(s, my_disks, opp_disks, threads, true,
+                                OTHELLO_SOLVE_EXACT, 0, 0, 0, &depth, &score);
+        }
+        solve_root(s, my_disks, opp_disks, OTHELLO_SOLVE_EXACT, &move_idx);
+
+        return move_idx;
+}
+
+/* Find p's move as othello_compute_move_stoppable() describes, with s set
+   up and the given number of threads. Returns the move and sets *depth to
+   the depth searched. */
+static int compute_move(search_t *s, const othello_t *o, player_t p, int ms,
+                        int threads, int *depth)
+{
+        int move_idx, solve_idx, empties;
+        uint64_t my_disks = o->disks[p], opp_disks = o->disks[p ^ 1];
+
+        assert(othello_has_valid_move(o, p));
+
+        s->start_time = clock_ns();
+        if (ms > 0) {
+                s->deadline = s->start_time + (uint64_t)ms * 1000000;
+        }
+        empties = popcount(~(my_disks | opp_disks));
+        *depth = empties;
+
+        if (book_move(s, o, p, &move_idx, depth)) {
+                /* Nothing to search. */
+        } else if ((s->features & OTHELLO_SEARCH_ENDGAME) &&
+                   empties <= endgame_empties && s->deadline == 0 &&
+                   s->stop == NULL) {
+                move_idx = run_solve(s, my_disks, opp_disks, threads);
+        } else if ((s->features & OTHELLO_SEARCH_ENDGAME) &&
+                   empties <= endgame_empties) {
+                /* Try to solve the game, falling back to a shallow search
+                   if it does not finish in time. */
+                move_idx = run_iterative(s, my_disks, opp_disks, threads, 1,
+                                         TIMED_SOLVE_DEPTH, INT_MAX, depth);
+                solve_idx = run_solve(s, my_disks, opp_disks, threads);
+                if (!s->aborted) {
+                        move_idx = solve_idx;
+                        *depth = empties;
+                }
+        } else if (s->deadline != 0) {
+                move_idx = run_iterative(s, my_disks, opp_disks, threads, 1,
+                                         INT_MAX, INT_MAX, depth);
+        } else {
+                move_idx = run_iterative(s, my_disks, opp_disks, threads,
+                                         START_DEPTH, INT_MAX, EVAL_BUDGET,
+                                         depth);
+        }
+
+        assert(move_idx != -1 && "No move found?");
+        tt_new_generation(s->tt);
+
+        return move_idx;
+}
+
+void othello_compute_move_stoppable(const othello_t *o, player_t p, int ms,
+                                    int features, othello_stop_t *stop,
+                                    int *row, int *col,
+                                    othello_search_info_t *info)
+{
+        search_t s;
+        int move_idx, depth;
+
+        search_init(&s, NULL, features);
+        s.stop = stop;
+        move_idx = compute_move(&s, o, p, ms, 1, &depth);
+
+        *row = move_idx / 8;
+        *col = move_idx % 8;
+
+        fill_info(&s, depth, move_idx, info);
+}
+
+/* Threads. */
+
+#define MAX_THREADS 64
+#define MAX_DEPTH 64
+
+#ifdef _WIN32
+#define THREAD_FUNC unsigned __stdcall
+#define THREAD_RETURN 0
+typedef unsigned (__stdcall *thread_func_t)(void *);
+#else
+#define THREAD_FUNC void *
+#define THREAD_RETURN NULL
+typedef void *(*thread_func_t)(void *);
+#endif
+
+static bool thread_start(thread_t *t, thread_func_t f, void *arg)
+{
+#ifdef OTHELLO_NO_THREADS
+        (void)t; (void)f; (void)arg;
+        return false;
+#elif defined(_WIN32)
+        *t = (HANDLE)_beginthreadex(NULL, 0, f, arg, 0, NULL);
+        return *t != 0;
+#else
+        return pthread_create(t, NULL, f, arg) == 0;
+#endif
+}
+
+static void thread_join(thread_t t)
+{
+#ifdef OTHELLO_NO_THREADS
+        (void)t;
+#elif defined(_WIN32)
+        WaitForSingleObject(t, INFINITE);
+        CloseHandle(t);
+#else
+        pthread_join(t, NULL);
+#endif
+}
+
+#ifdef OTHELLO_NO_THREADS
+#elif defined(_WIN32)
+#define mutex_init(m) InitializeCriticalSection(m)
+#define mutex_destroy(m) DeleteCriticalSection(m)
+#define mutex_lock(m) EnterCriticalSection(m)
+#define mutex_unlock(m) LeaveCriticalSection(m)
+#define cond_init(c) InitializeConditionVariable(c)
+#define cond_destroy(c) ((void)(c))
+#define cond_wait(c, m) SleepConditionVariableCS((c), (m), INFINITE)
+#define cond_broadcast(c) WakeAllConditionVariable(c)
+#else
+#define mutex_init(m) pthread_mutex_init((m), NULL)
+#define mutex_destroy(m) pthread_mutex_destroy(m)
+#define mutex_lock(m) pthread_mutex_lock(m)
+#define mutex_unlock(m) pthread_mutex_unlock(m)
+#define cond_init(c) pthread_cond_init((c), NULL)
+#define cond_destroy(c) pthread_cond_destroy(c)
+#define cond_wait(c, m) pthread_cond_wait((c), (m))
+#define cond_broadcast(c) pthread_cond_broadcast(c)
+#endif
+
+static int clamp_threads(int threads)
+{
+        return threads < 1 ? 1 : threads > MAX_THREADS ? MAX_THREADS : threads;
+}
+
+static void add_stats(search_t *s, const search_t *t)
+{
+        int i;
+
+        s->nodes += t->nodes;
+        s->tt_probes += t->tt_probes;
+        s->tt_hits += t->tt_hits;
+        s->seldepth = t->seldepth > s->seldepth ? t->seldepth : s->seldepth;
+        for (i = 0; i < OTHELLO_MAX_PLY; i++) {
+                s->cutoffs[i] += t->cutoffs[i];
+                s->first_cutoffs[i] += t->first_cutoffs[i];
+        }
+}
+
+/* Lazy SMP: helper threads run their own search of the same position,
+   sharing results through the transposition tables, while the main
+   thread's search determines the move. For iterative deepening, half the
+   helpers start one ply deeper, so they tend to work ahead of each other. */
+
+typedef struct {
+        search_t s;
+        uint64_t my_disks;
+        uint64_t opp_disks;
+        bool solving;
+        othello_solve_mode_t mode;
+        int start_depth;
+        int max_depth;
+        thread_t thread;
+} helper_t;
+
+static THREAD_FUNC lazy_smp_helper(void *arg)
+{
+        helper_t *h = arg;
+        int depth, move;
+
+        if (h->solving) {
+                solve_root(&h->s, h->my_disks, h->opp_disks, h->mode, &move);
+                return THREAD_RETURN;
+        }
+
+        eval_state_init(&h->s.eval_state, h->s.evaluator,
+                        h->s.features & OTHELLO_SEARCH_INCREMENTAL,
+                        h->my_disks, h->opp_disks);
+        for (depth = h->start_depth; depth <= h->max_depth; depth++) {
+                negamax(&h->s, h->my_disks, h->opp_disks, depth, -INT_MAX,
+                        INT_MAX, &move);
+                if (h->s.aborted) {
+                        break;
+                }
+        }
+
+        return THREAD_RETURN;
+}
+
+/* Run iterative_negamax(), or solve_root() if solving, with helpers. */
+static int lazy_smp(search_t *s, uint64_t my_disks, uint64_t opp_disks,
+                    int threads, bool solving, othello_solve_mode_t mode,
+                    int start_depth, int max_depth, int eval_budget,
+                    int *depth_reached, int *score)
+{
+        othello_stop_t stop = 0;
+        helper_t *helpers;
+        int i, n, move_idx;
+
+        threads = clamp_threads(threads);
+        init_zobrist();
+
+        n = 0;
+        helpers = calloc((size_t)threads, sizeof(*helpers));
+        for (i = 0; helpers != NULL && i < threads - 1; i++) {
+                search_init_from(&helpers[i].s, s);
+                helpers[i].s.stop = &stop;
+                helpers[i].my_disks = my_disks;
+                helpers[i].opp_disks = opp_disks;
+                helpers[i].solving = solving;
+                helpers[i].mode = mode;
+                helpers[i].start_depth = start_depth + (i & 1);
+                helpers[i].max_depth = max_depth < MAX_DEPTH ? max_depth :
+                                       MAX_DEPTH;
+                if (!thread_start(&helpers[i].thread, lazy_smp_helper,
+                                  &helpers[i])) {
+                        break;
+                }
+                n++;
+        }
+
+        move_idx = -1;
+        if (solving) {
+                *score = solve_root(s, my_disks, opp_disks, mode, &move_idx);
+                *depth_reached = popcount(~(my_disks | opp_disks));
+        } else {
+                move_idx = iterative_negamax(s, my_disks, opp_disks,
+                                             start_depth, max_depth,
+                                             eval_budget, depth_reached);
+        }
+
+        store_relaxed(STOP_FLAG(&stop), 1);
+        for (i = 0; i < n; i++) {
+                thread_join(helpers[i].thread);
+                add_stats(s, &helpers[i].s);
+        }
+        free(helpers);
+
+        return move_idx;
+}
+
+/* Young Brothers Wait: a node's first move is searched alone, and if it
+   doesn't cause a cutoff, the remaining moves are put up at a split point.
+   Idle threads steal moves from open split points; a cutoff at one aborts
+   the threads still searching below it. */
+
+#define MAX_SPLITS 256
+
+#ifdef OTHELLO_NO_THREADS
+static bool can_split(const search_t *s)
+{
+        (void)s;
+        return false;
+}
+
+static bool split(search_t *s, bool solving, int depth, const move_t *moves,
+                  int n_moves, int alpha, int beta, int *best, int *best_idx)
+{
+        (void)s; (void)solving; (void)depth; (void)moves; (void)n_moves;
+        (void)alpha; (void)beta; (void)best; (void)best_idx;
+        return false;
+}
+#else
+typedef struct {
+        search_t s;
+        thread_t thread;
+} worker_t;
+
+struct pool {
+        mutex_t lock;           /* Protects the pool and its split points. */
+        cond_t cond;            /* Signalled when work appears or ends. */
+        split_t *splits[MAX_SPLITS];
+        int n_splits;
+        ATOMIC(int) idle;       /* Read without the lock. */
+        bool quit;
+        worker_t *workers;
+        int n_workers;
+};
+
+static bool can_split(const search_t *s)
+{
+        return s->pool != NULL && load_relaxed(&s->pool->idle) > 0;
+}
+
+static bool is_below(const split_t *sp, const split_t *ancestor)
+{
+        for (; sp != NULL; sp = sp->parent) {
+                if (sp == ancestor) {
+                        return true;
+                }
+        }
+
+        return false;
+}
+
+/* Find a split point with moves left, below ancestor if non-NULL. The pool
+   must be locked. */
+static split_t *find_split(pool_t *pool, const split_t *ancestor)
+{
+        split_t *sp;
+        int i;
+
+        for (i = pool->n_splits - 1; i >= 0; i--) {
+                sp = pool->splits[i];
+                if (sp->next < sp->n_moves && !load_relaxed(&sp->cutoff) &&
+                    (ancestor == NULL || is_below(sp, ancestor))) {
+                        return sp;
+                }
+        }
+
+        return NULL;
+}
+
+static int split_child(search_t *s, const split_t *sp, const move_t *m,
+                       int alpha, int beta)
+{
+        eval_state_t saved;
+        int saved_ply = s->ply;
+        int v;
+
+        s->ply = sp->ply + 1;
+        if (sp->solving) {
+                v = -solve(s, m->opp_disks, m->my_disks, -alpha - 1, -alpha,
+                           NULL);
+                if (!s->aborted && v > alpha && v < beta) {
+                        v = -solve(s, m->opp_disks, m->my_disks, -beta,
+                                   -alpha, NULL);
+                }
+        } else {
+                /* This thread may be searching elsewhere further up, so
+                   set up the child's evaluation state from scratch. */
+                saved = s->eval_state;
+                eval_state_init(&s->eval_state, s->evaluator,
+                                s->features & OTHELLO_SEARCH_INCREMENTAL,
+                                m->opp_disks, m->my_disks);
+                v = -negamax(s, m->opp_disks, m->my_disks, sp->depth - 1,
+                             -alpha - 1, -alpha, NULL);
+                if (!s->aborted && v > alpha && v < beta) {
+                        v = -negamax(s, m->opp_disks, m->my_disks,
+                                     sp->depth - 1, -beta, -alpha, NULL);
+                }
+                s->eval_state = saved;
+        }
+        s->ply = saved_ply;
+
+        return v;
+}
+
+/* Search moves of sp until there are none left. The caller must have
+   counted this thread in sp->workers. */
+static void work_at(search_t *s, split_t *sp)
+{
+        pool_t *pool = s->pool;
+        split_t *saved = s->split;
+        const move_t *m;
+        int alpha, beta, v;
+
+        s->split = sp;
+        mutex_lock(&pool->lock);
+
+        while (sp->next < sp->n_moves && !load_relaxed(&sp->cutoff)) {
+                m = &sp->moves[sp->next++];
+                alpha = sp->alpha;
+                beta = sp->beta;
+                mutex_unlock(&pool->lock);
+
+                v = split_child(s, sp, m, alpha, beta);
+
+                mutex_lock(&pool->lock);
+                if (s->aborted) {
+                        /* Stopped, or a cutoff here or above. */
+                        break;
+                }
+                if (v > sp->best) {
+                        sp->best = v;
+                        sp->best_idx = m->idx;
+                        if (v > sp->alpha) {
+                                sp->alpha = v;
+                                if (v >= sp->beta) {
+                                        store_relaxed(&sp->cutoff, 1);
+                                }
+                        }
+                }
+        }
+
+        if (--sp->workers == 0) {
+                cond_broadcast(&pool->cond);
+        }
+        mutex_unlock(&pool->lock);
+
+        s->split = saved;
+        s->aborted = false;
+}
+
+static bool split(search_t *s, bool solving, int depth, const move_t *moves,
+                  int n_moves, int alpha, int beta, int *best, int *best_idx)
+{
+        pool_t *pool = s->pool;
+        split_t sp, *other;
+        int i;
+
+        sp.parent = s->split;
+        sp.solving = solving;
+        sp.depth = depth;
+        sp.moves = moves;
+        sp.n_moves = n_moves;
+        sp.next = 0;
+        sp.alpha = alpha;
+        sp.beta = beta;
+        sp.best = *best;
+        sp.best_idx = *best_idx;
+        sp.ply = s->ply;
+        sp.workers = 1;
+        store_relaxed(&sp.cutoff, 0);
+
+        mutex_lock(&pool->lock);
+        if (pool->n_splits == MAX_SPLITS) {
+                mutex_unlock(&pool->lock);
+                return false;
+        }
+        pool->splits[pool->n_splits++] = &sp;
+        cond_broadcast(&pool->cond);
+        mutex_unlock(&pool->lock);
+
+        work_at(s, &sp);
+
+        /* Wait for the helpers, meanwhile helping them with split points
+           further down. */
+        mutex_lock(&pool->lock);
+        while (sp.workers > 0) {
+                if ((other = find_split(pool, &sp)) != NULL) {
+                        other->workers++;
+                        mutex_unlock(&pool->lock);
+                        work_at(s, other);
+                        mutex_lock(&pool->lock);
+                } else {
+                        cond_wait(&pool->cond, &pool->lock);
+                }
+        }
+        for (i = 0; pool->splits[i] != &sp; i++) {
+                assert(i < pool->n_splits);
+        }
+        pool->splits[i] = pool->splits[--pool->n_splits];
+        mutex_unlock(&pool->lock);
+
+        *best = sp.best;
+        *best_idx = sp.best_idx;
+        s->aborted = should_abort(s);
+
+        return true;
+}
+
+static THREAD_FUNC ybwc_worker(void *arg)
+{
+        worker_t *w = arg;
+        pool_t *pool = w->s.pool;
+        split_t *sp;
+
+        mutex_lock(&pool->lock);
+        while (!pool->quit) {
+                if ((sp = find_split(pool, NULL)) != NULL) {
+                        sp->workers++;
+                        mutex_unlock(&pool->lock);
+                        work_at(&w->s, sp);
+                        mutex_lock(&pool->lock);
+                } else {
+                        store_relaxed(&pool->idle,
+                                      load_relaxed(&pool->idle) + 1);
+                        cond_wait(&pool->cond, &pool->lock);
+                        store_relaxed(&pool->idle,
+                                      load_relaxed(&pool->idle) - 1);
+                }
+        }
+        mutex_unlock(&pool->lock);
+
+        return THREAD_RETURN;
+}
+#endif
+
+/* Run iterative_negamax(), or solve_root() if solving, splitting the tree
+   between threads. */
+static int ybwc(search_t *s, uint64_t my_disks, uint64_t opp_disks,
+                int threads, bool solving, othello_solve_mode_t mode,
+                int max_depth, int *depth_reached, int *score)
+{
+        int move_idx = -1;
+#ifndef OTHELLO_NO_THREADS
+        pool_t *pool;
+        int i;
+
+        threads = clamp_threads(threads);
+        init_zobrist();
+
+        pool = calloc(1, sizeof(*pool));
+        if (pool != NULL && threads > 1) {
+                pool->workers = calloc((size_t)threads, sizeof(worker_t));
+        }
+        if (pool != NULL && pool->workers != NULL) {
+                mutex_init(&pool->lock);
+                cond_init(&pool->cond);
+                for (i = 0; i < threads - 1; i++) {
+                        search_init_from(&pool->workers[i].s, s);
+                        pool->workers[i].s.pool = pool;
+                        if (!thread_start(&pool->workers[i].thread,
+                                          ybwc_worker, &pool->workers[i])) {
+                                break;
+                        }
+                        pool->n_workers++;
+                }
+                s->pool = pool;
+        }
+#endif
+
+        if (solving) {
+                *score = solve_root(s, my_disks, opp_disks, mode, &move_idx);
+                *depth_reached = popcount(~(my_disks | opp_disks));
+        } else {
+                move_idx = iterative_negamax(s, my_disks, opp_disks, 1,
+                                             max_depth, INT_MAX,
+                                             depth_reached);
+        }
+
+#ifndef OTHELLO_NO_THREADS
+        if (s->pool != NULL) {
+                mutex_lock(&pool->lock);
+                pool->quit = true;
+                cond_broadcast(&pool->cond);
+                mutex_unlock(&pool->lock);
+
+                for (i = 0; i < pool->n_workers; i++) {
+                        thread_join(pool->workers[i].thread);
+                        add_stats(s, &pool->workers[i].s);
+                }
+                cond_destroy(&pool->cond);
+                mutex_destroy(&pool->lock);
+                s->pool = NULL;
+        }
+        if (pool != NULL) {
+                free(pool->workers);
+        }
+        free(pool);
+#else
+        (void)threads;
+#endif
+
+        return move_idx;
+}
+
+void othello_compute_move_mt(const othello_t *o, player_t p, int threads,
+                             int *row, int *col)
+{
+        search_t s;
+        int move_idx, depth, score;
+        uint64_t my_disks = o->disks[p], opp_disks = o->disks[p ^ 1];
+
+        assert(othello_has_valid_move(o, p));
+
+        search_init(&s, NULL, OTHELLO_SEARCH_ALL);
+
+        /* Tree splitting works best without heuristic noise, while Lazy SMP
+           suits iterative deepening with a budget. */
+        if (book_move(&s, o, p, &move_idx, &depth)) {
+                /* Nothing to search. */
+        } else if (popcount(~(my_disks | opp_disks)) <= endgame_empties) {
+                move_idx = ybwc(&s, my_disks, opp_disks, threads, true,
+                                OTHELLO_SOLVE_EXACT, 0, &depth, &score);
+        } else {
+                move_idx = lazy_smp(&s, my_disks, opp_disks, threads, false,
+                                    OTHELLO_SOLVE_EXACT, START_DEPTH, INT_MAX,
+                                    EVAL_BUDGET, &depth, &score);
+        }
+
+        assert(move_idx != -1 && "No move found?");
+        tt_new_generation(s.tt);
+
+        *row = move_idx / 8;
+        *col = move_idx % 8;
+}
+
+int othello_iterative_negamax_mt(const othello_t *o, player_t p, int depth,
+                                 int threads, othello_parallel_t method,
+                                 othello_search_info_t *info)
+{
+        search_t s;
+        int move_idx, depth_reached = 0, score;
+
+        search_init(&s, NULL, OTHELLO_SEARCH_ALL);
+        s.start_time = clock_ns();
+        if (method == OTHELLO_PARALLEL_YBWC) {
+                move_idx = ybwc(&s, o->disks[p], o->disks[p ^ 1], threads,
+                                false, OTHELLO_SOLVE_EXACT, depth,
+                                &depth_reached, &score);
+        } else {
+                move_idx = lazy_smp(&s, o->disks[p], o->disks[p ^ 1], threads,
+                                    false, OTHELLO_SOLVE_EXACT, 1, depth,
+                                    INT_MAX, &depth_reached, &score);
+        }
+        fill_info(&s, depth_reached, move_idx, info);
+
+        return move_idx;
+}
+
+int othello_solve_mt(const othello_t *o, player_t p, othello_solve_mode_t mode,
+                     int threads, othello_parallel_t method, int *row,
+                     int *col, othello_search_info_t *info)
+{
+        search_t s;
+        int move_idx, depth, score;
+
+        assert(othello_has_valid_move(o, p));
+
+        search_init(&s, NULL, OTHELLO_SEARCH_ALL);
+        s.start_time = clock_ns();
+        if (method == OTHELLO_PARALLEL_YBWC) {
+                move_idx = ybwc(&s, o->disks[p], o->disks[p ^ 1], threads,
+                                true, mode, 0, &depth, &score);
+        } else {
+                move_idx = lazy_smp(&s, o->disks[p], o->disks[p ^ 1], threads,
+                                    true, mode, 0, 0, 0, &depth, &score);
+        }
+        fill_info(&s, depth, move_idx, info);
+
+        *row = move_idx / 8;
+        *col = move_idx % 8;
+
+        return score;
+}
+
+/* Pondering. The thread searches one position until stopped; the hash
+   tables keep what it found for the search that follows. */
+
+#define PONDER_PREDICT_DEPTH 4
+
+typedef struct {
+        bool running;
+        thread_t thread;
+        othello_stop_t stop;
+        othello_engine_t *engine;       /* Whose settings to use, or NULL. */
+        int features;
+        int threads;
+        uint64_t my_disks;      /* Of the computer, to move. */
+        uint64_t opp_disks;
+} ponder_t;
+
+static THREAD_FUNC ponder_thread(void *arg)
+{
+        ponder_t *pd = arg;
+        search_t s;
+        int empties, depth;
+
+        search_init(&s, pd->engine, pd->features);
+        s.stop = &pd->stop;
+        s.start_time = clock_ns();
+        empties = popcount(~(pd->my_disks | pd->opp_disks));
+
+        if ((s.features & OTHELLO_SEARCH_ENDGAME) &&
+            empties <= endgame_empties) {
+                run_solve(&s, pd->my_disks, pd->opp_disks, pd->threads);
+        } else {
+                run_iterative(&s, pd->my_disks, pd->opp_disks, pd->threads, 1,
+                              empties, INT_MAX, &depth);
+        }
+
+        return THREAD_RETURN;
+}
+
+static void stop_ponder(ponder_t *pd)
+{
+        if (!pd->running) {
+                return;
+        }
+
+        store_relaxed(STOP_FLAG(&pd->stop), 1);
+        thread_join(pd->thread);
+        pd->running = false;
+}
+
+static bool start_ponder(ponder_t *pd, othello_engine_t *engine,
+                         int features, int threads, const othello_t *o,
+                         player_t p, int move)
+{
+        search_t s;
+        othello_t next;
+        int depth;
+
+        stop_ponder(pd);
+
+        if (!othello_has_valid_move(o, p)) {
+                return false;
+        }
+
+        search_init(&s, engine, features);
+        if (move == -1 && !book_move(&s, o, p, &move, &depth)) {
+                move = iterative_negamax(&s, o->disks[p], o->disks[p ^ 1], 1,
+                                         PONDER_PREDICT_DEPTH, INT_MAX,
+                                         &depth);
+        }
+        assert(othello_is_valid_move(o, p, move / 8, move % 8));
+
+        next = *o;
+        othello_make_move(&next, p, move / 8, move % 8);
+        p ^= 1;
+        if (!othello_has_valid_move(&next, p)) {
+                /* The computer would have to pass. */
+                return false;
+        }
+        if (book_move(&s, &next, p, &move, &depth)) {
+                /* Nothing to search. */
+                return false;
+        }
+
+        init_zobrist();
+        pd->engine = engine;
+        pd->features = features;
+        pd->threads = threads;
+        pd->my_disks = next.disks[p];
+        pd->opp_disks = next.disks[p ^ 1];
+        store_relaxed(STOP_FLAG(&pd->stop), 0);
+        pd->running = thread_start(&pd->thread, ponder_thread, pd);
+
+        return pd->running;
+}
+
+/* Pondering by the functions without an engine. */
+static ponder_t default_ponder;
+
+bool othello_start_pondering(const othello_t *o, player_t p, int move,
+                             int features)
+{
+        return start_ponder(&default_ponder, NULL, features, 1, o, p, move);
+}
+
+void othello_stop_pondering(void)
+{
+        stop_ponder(&default_ponder);
+}
+
+/* Engines. */
+
+struct othello_engine {
+        tt_t tt;
+        eg_entry_t *eg_tt;
+        book_t book;
+        othello_evaluator_t evaluator;
+        int threads;
+        int features;
+        ponder_t ponder;
+};
+
+#define MIN_TT_CLUSTERS 256
+#define HUGE_PAGE_SIZE (2 << 20)
+
+/* Allocate zeroed, cache-aligned memory for a table, asking for it to be
+   backed by huge pages if huge. Returns NULL on failure. */
+static void *alloc_table(size_t size, bool huge)
+{
+        void *p;
+
+#ifdef _WIN32
+        (void)huge;
+        p = _aligned_malloc(size, 64);
+        if (p == NULL) {
+                return NULL;
+        }
+#else
+        if (posix_memalign(&p, huge ? HUGE_PAGE_SIZE : 64, size) != 0) {
+                return NULL;
+        }
+#ifdef MADV_HUGEPAGE
+        if (huge) {
+                /* Only a hint; the table works the same without. */
+                madvise(p, size, MADV_HUGEPAGE);
+        }
+#else
+        (void)huge;
+#endif
+#endif
+        memset(p, 0, size);
+
+        return p;
+}
+
+static void free_table(void *p)
+{
+#ifdef _WIN32
+        _aligned_free(p);
+#else
+        free(p);
+#endif
+}
+
+/* Set up a search with the engine's hash tables, evaluator and book, or
+   with NULL, the global ones. */
+static void search_init(search_t *s, othello_engine_t *engine, int features)
+{
+        memset(s, 0, sizeof(*s));
+        s->features = features;
+        if (engine == NULL) {
+                s->evaluator = evaluator;
+                s->tt = &default_tt;
+                s->generation = load_relaxed(&s->tt->generation);
+                s->eg_tt = eg_tt;
+                s->book = &default_book;
+                return;
+        }
+
+        s->evaluator = engine->evaluator;
+        if ((s->evaluator == OTHELLO_EVAL_PATTERNS && weights == NULL) ||
+            (s->evaluator == OTHELLO_EVAL_NETWORK && network == NULL)) {
+                /* It was unloaded. */
+                s->evaluator = OTHELLO_EVAL_BUILTIN;
+        }
+        s->tt = &engine->tt;
+        s->generation = load_relaxed(&s->tt->generation);
+        s->eg_tt = engine->eg_tt;
+        s->book = &engine->book;
+}
+
+/* Set up a helper thread's search like the one it helps. */
+static void search_init_from(search_t *s, const search_t *from)
+{
+        s->features = from->features;
+        s->evaluator = from->evaluator;
+        s->tt = from->tt;
+        s->generation = from->generation;
+        s->eg_tt = from->eg_tt;
+        s->book = from->book;
+}
+
+void othello_engine_default_config(othello_engine_config_t *config)
+{
+        config->hash_size = TT_SIZE * sizeof(tt_entry_t);
+        config->huge_pages = false;
+        config->threads = 1;
+        config->evaluator = evaluator;
+        config->book = NULL;
+        config->features = OTHELLO_SEARCH_ALL;
+}
+
+othello_engine_t *othello_engine_create(const othello_engine_config_t *config)
+{
+        othello_engine_t *e;
+        size_t clusters;
+
+        if ((config->evaluator == OTHELLO_EVAL_PATTERNS && weights == NULL) ||
+            (config->evaluator == OTHELLO_EVAL_NETWORK && network == NULL)) {
+                return NULL;
+        }
+
+        e = calloc(1, sizeof(*e));
+        if (e == NULL) {
+                return NULL;
+        }
+        clusters = MIN_TT_CLUSTERS;
+        while (clusters * 2 * sizeof(tt_cluster_t) <= config->hash_size) {
+                clusters *= 2;
+        }
+        e->tt.clusters = alloc_table(clusters * sizeof(tt_cluster_t),
+                                     config->huge_pages);
+        e->tt.mask = clusters - 1;
+        store_relaxed(&e->tt.generation, 1);
+        e->eg_tt = alloc_table(EG_TT_SIZE * sizeof(eg_entry_t), false);
+        e->evaluator = config->evaluator;
+        e->threads = clamp_threads(config->threads);
+        e->features = config->features;
+        if (e->tt.clusters == NULL || e->eg_tt == NULL ||
+            (config->book != NULL && !book_load(&e->book, config->book))) {
+                othello_engine_destroy(e);
+                return NULL;
+        }
+        init_zobrist();
+
+        return e;
+}
+
+void othello_engine_destroy(othello_engine_t *e)
+{
+        if (e == NULL) {
+                return;
+        }
+
+        stop_ponder(&e->ponder);
+        book_unload(&e->book);
+        free_table(e->tt.clusters);
+        free_table(e->eg_tt);
+        free(e);
+}
+
+void othello_engine_clear_hash(othello_engine_t *e)
+{
+        stop_ponder(&e->ponder);
+        memset(e->tt.clusters, 0, (e->tt.mask + 1) * sizeof(tt_cluster_t));
+        memset(e->eg_tt, 0, EG_TT_SIZE * sizeof(eg_entry_t));
+}
+
+void othello_engine_compute_move(othello_engine_t *e, const othello_t *o,
+                                 player_t p, int ms, othello_stop_t *stop,
+                                 int *row, int *col,
+                                 othello_search_info_t *info)
+{
+        search_t s;
+        int move_idx, depth;
+
+        stop_ponder(&e->ponder);
+
+        search_init(&s, e, e->features);
+        s.stop = stop;
+        move_idx = compute_move(&s, o, p, ms, e->threads, &depth);
+
+        *row = move_idx / 8;
+        *col = move_idx % 8;
+
+        fill_info(&s, depth, move_idx, info);
+}
+
+int othello_engine_negamax(othello_engine_t *e, const othello_t *o,
+                           player_t p, int depth,
+                           othello_search_info_t *info)
+{
+        search_t s;
+
+        stop_ponder(&e->ponder);
+        search_init(&s, e, e->features);
+
+        return fixed_depth_search(&s, o, p, depth, info);
+}
+
+bool othello_engine_start_pondering(othello_engine_t *e, const othello_t *o,
+                                    player_t p, int move)
+{
+        return start_ponder(&e->ponder, e, e->features, e->threads, o, p,
+                            move);
+}
+
+void othello_engine_stop_pondering(othello_engine_t *e)
+{
+        stop_ponder(&e->ponder);
+}
+
+#ifdef OTHELLO_TESTING
+
+/* Hash table stress test, only built for the tests. Threads store and
+   probe a small set of keys in a table of a few clusters, so entries are
+   overwritten all the time. The data stored for a key is derived from it,
+   so any probe that succeeds can be checked. Returns the number of probes
+   that found other data, which should be 0. */
+
+#define STRESS_CLUSTERS 16
+#define STRESS_KEYS 1024
+
+typedef struct {
+        tt_t *tt;
+        const uint64_t *keys;
+        uint64_t seed;
+        int iterations;
+        uint64_t corrupted;
+        thread_t thread;
+} stress_t;
+
+static void stress_data(uint64_t key, tt_data_t *d)
+{
+        d->score = (int32_t)(uint32_t)key;
+        d->depth = (int)(key >> 32 & 63);
+        d->bound = (int)(key >> 40 & 1);
+        d->best_move = (int)(key >> 48 & 63);
+        d->generation = 1;
+}
+
+static THREAD_FUNC stress_thread(void *arg)
+{
+        stress_t *st = arg;
+        tt_data_t d, expected;
+        uint64_t r, key;
+        int i;
+
+        for (i = 0; i < st->iterations; i++) {
+                r = splitmix64(&st->seed);
+                key = st->keys[r % STRESS_KEYS];
+                stress_data(key, &expected);
+                if (r & (1ULL << 63)) {
+                        tt_store(st->tt, key, &expected);
+                } else if (tt_probe(st->tt, key, &d) &&
+                           memcmp(&d, &expected, sizeof(d)) != 0) {
+                        st->corrupted++;
+                }
+        }
+
+        return THREAD_RETURN;
+}
+
+uint64_t othello_hash_stress(int threads, int iterations)
+{
+        uint64_t keys[STRESS_KEYS], seed = 1, corrupted = 0;
+        stress_t st[MAX_THREADS];
+        tt_t tt;
+        int i, n;
+
+        threads = clamp_threads(threads);
+        for (i = 0; i < STRESS_KEYS; i++) {
+                /* A zeroed entry matches key 0. */
+                keys[i] = splitmix64(&seed) | 1;
+        }
+        tt.clusters = alloc_table(STRESS_CLUSTERS * sizeof(tt_cluster_t),
+                                  false);
+        tt.mask = STRESS_CLUSTERS - 1;
+        store_relaxed(&tt.generation, 1);
+        if (tt.clusters == NULL) {
+                return 0;
+        }
+
+        for (i = 0; i < threads; i++) {
+                st[i].tt = &tt;
+                st[i].keys = keys;
+                st[i].seed = (uint64_t)i + 1;
+                st[i].iterations = iterations;
+                st[i].corrupted = 0;
+        }
+        for (n = 1; n < threads; n++) {
+                if (!thread_start(&st[n].thread, stress_thread, &st[n])) {
+                        break;
+                }
+        }
+        stress_thread(&st[0]);
+        for (i = 0; i < n; i++) {
+                if (i > 0) {
+                        thread_join(st[i].thread);
+                }
+                corrupted += st[i].corrupted;
+        }
+        free_table(tt.clusters);
+
+        return corrupted;
+}
+
+#endif
 
 void othello_compute_random_move(const othello_t *o, player_t p,
                                  int *row, int *col)
@@ -2,6 +2,7 @@
 #define OTHELLO_H
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 typedef struct {
@@ -46,6 +47,136 @@ void othello_make_move(othello_t *o, player_t p, int row, int col);
 /* Compute a good move for player p. */
 void othello_compute_move(const othello_t *o, player_t p, int *row, int *col);
 
+typedef enum {
+        OTHELLO_SOLVE_WLD,      /* Only determine win, loss or draw. */
+        OTHELLO_SOLVE_EXACT     /* Determine the final disk difference. */
+} othello_solve_mode_t;
+
+/* Compute a perfect move for player p by searching to the end of the game.
+   Returns the disk difference for p with perfect play; in WLD mode, only its
+   sign is meaningful. */
+int othello_solve(const othello_t *o, player_t p, othello_solve_mode_t mode,
+                  int *row, int *col);
+
+/* Like othello_compute_move(), using the given number of threads. */
+void othello_compute_move_mt(const othello_t *o, player_t p, int threads,
+                             int *row, int *col);
+
+/* Set the number of empty cells at which othello_compute_move() starts
+   solving the game exactly. */
+void othello_set_endgame_empties(int empties);
+
+/* Evaluation functions. */
+typedef enum {
+        OTHELLO_EVAL_BUILTIN,   /* Hand-tuned terms. */
+        OTHELLO_EVAL_PATTERNS,  /* Needs othello_load_weights(). */
+        OTHELLO_EVAL_NETWORK    /* Needs othello_load_network(). */
+} othello_evaluator_t;
+
+/* Switch to another evaluation function. Returns false if its weights are
+   not loaded. Must not be called during a search. */
+bool othello_set_evaluator(othello_evaluator_t e);
+
+/* Evaluate positions with the pattern weights in the given file, which is
+   mapped into memory and must not be modified while in use. Returns false if
+   it is not a valid weight file, in which case the current evaluation is
+   kept. Must not be called during a search. */
+bool othello_load_weights(const char *path);
+
+/* Unload the pattern weights, going back to the built-in evaluation if they
+   were in use. */
+void othello_unload_weights(void);
+
+/* Like othello_load_weights() and othello_unload_weights(), for a neural
+   network written by othello_save_network(). */
+bool othello_load_network(const char *path);
+void othello_unload_network(void);
+
+/* Opening book: the best moves of positions, which othello_compute_move()
+   plays without searching. Rotations and reflections of a position share
+   its entry. */
+#define OTHELLO_BOOK_MOVES 4
+
+typedef struct {
+        int n_moves;
+        int moves[OTHELLO_BOOK_MOVES];  /* row * 8 + col, best first. */
+        int scores[OTHELLO_BOOK_MOVES]; /* For the side to move. */
+        int depth;                      /* Of the searches scoring them. */
+} othello_book_moves_t;
+
+/* Use the opening book in the given file, which is mapped into memory and
+   must not be modified while in use. Returns false if it is not a valid
+   book file, in which case the current book is kept. Must not be called
+   during a search. */
+bool othello_load_book(const char *path);
+
+/* Unload the book, including positions added to it. */
+void othello_unload_book(void);
+
+/* Find p's moves in o in the book. Returns false if it is not there. */
+bool othello_book_lookup(const othello_t *o, player_t p,
+                         othello_book_moves_t *moves);
+
+/* Add a position to the book in memory, replacing any entry for it.
+   Returns false if out of memory. */
+bool othello_book_add(const othello_t *o, player_t p,
+                      const othello_book_moves_t *moves);
+
+/* Write the book with the added positions to a file for
+   othello_load_book(), unloading it. Returns false on failure, keeping
+   the book if the file could not be written. */
+bool othello_save_book(const char *path);
+
+/* Pattern evaluation weights, for training: a position's evaluation is the
+   sum of the weights of its features. */
+#define OTHELLO_NUM_PATTERNS 46
+#define OTHELLO_NUM_WEIGHTS (13 * 167265)
+
+/* Store the indices of the weights that make up the evaluation of the
+   position for player p in features, and return how many there are (at
+   most OTHELLO_NUM_PATTERNS). */
+int othello_pattern_features(const othello_t *o, player_t p, int *features);
+
+/* Write OTHELLO_NUM_WEIGHTS weights to a file for othello_load_weights(). */
+bool othello_save_weights(const char *path, const int16_t *weights);
+
+/* Neural network evaluation, for training. The 128 inputs are the side to
+   move's disks followed by the opponent's. hidden1[j] is b1[j] plus w1[i][j]
+   for each input i that is set, hidden2[k] is (b2[k] + sum of w2[k][j] *
+   hidden1[j]) / OTHELLO_NET_ONE, both clamped to [0, OTHELLO_NET_ONE], which
+   represents 1.0, and the evaluation is (b3 + sum of w3[k] * hidden2[k]) /
+   OTHELLO_NET_ONE. */
+#define OTHELLO_NET_INPUTS 128
+#define OTHELLO_NET_HIDDEN1 64
+#define OTHELLO_NET_HIDDEN2 16
+#define OTHELLO_NET_ONE 64
+
+typedef struct {
+        int16_t w1[OTHELLO_NET_INPUTS][OTHELLO_NET_HIDDEN1];
+        int16_t b1[OTHELLO_NET_HIDDEN1];
+        int16_t w2[OTHELLO_NET_HIDDEN2][OTHELLO_NET_HIDDEN1];
+        int32_t b2[OTHELLO_NET_HIDDEN2];
+        int16_t w3[OTHELLO_NET_HIDDEN2];
+        int32_t b3;
+} othello_network_t;
+
+/* Write a network to a file for othello_load_network(). */
+bool othello_save_network(const char *path, const othello_network_t *net);
+
+/* Network inference implementations. */
+typedef enum {
+        OTHELLO_SIMD_DEFAULT,
+        OTHELLO_SIMD_SCALAR,
+        OTHELLO_SIMD_SSE2,
+        OTHELLO_SIMD_AVX2
+} othello_simd_t;
+
+/* Evaluate a position with the loaded network and the given implementation.
+   Returns false if no network is loaded or the implementation is not
+   available on this machine. */
+bool othello_network_eval(const othello_t *o, player_t p, othello_simd_t impl,
+                          int *score);
+
 
 
 /* Utilities for testing, benchmarking, etc. */
@@ -57,4 +188,223 @@ int othello_eval(const othello_t *o, player_t p);
 int othello_negamax(const othello_t *o, player_t p, int depth);
 int othello_iterative_negamax(const othello_t *o, player_t p, int budget);
 
+/* Move generation implementations. */
+typedef enum {
+        OTHELLO_MOVEGEN_DEFAULT,
+        OTHELLO_MOVEGEN_DUMB7FILL,
+        OTHELLO_MOVEGEN_KOGGE_STONE,
+        OTHELLO_MOVEGEN_SSE2,
+        OTHELLO_MOVEGEN_AVX2
+} othello_movegen_t;
+
+/* Set bit row * 8 + col of *moves for each valid move, using the given
+   implementation. Returns false if it is not available on this machine. */
+bool othello_generate_moves(const othello_t *o, player_t p,
+                            othello_movegen_t impl, uint64_t *moves);
+
+/* Count the positions reached by playing every sequence of depth moves
+   from o, with p to move, for testing move generation. A pass counts as a
+   move, and a game that ends earlier counts once. With bulk, the last
+   moves are counted without being made. */
+uint64_t othello_perft(const othello_t *o, player_t p, int depth, bool bulk);
+
+/* Set bit row * 8 + col for each of p's disks that can never be flipped. */
+uint64_t othello_stable_disks(const othello_t *o, player_t p);
+
+/* Board symmetries. Transformation t, from 0 to OTHELLO_NUM_TRANSFORMS - 1,
+   reflects the board in the a1-h8 diagonal if bit 2 is set, then mirrors
+   it left to right if bit 0 is set, then flips it upside down if bit 1 is
+   set. */
+#define OTHELLO_NUM_TRANSFORMS 8
+
+/* Apply transformation t to a set of cells, bit row * 8 + col. */
+uint64_t othello_transform_cells(uint64_t cells, int t);
+
+/* The transformation that undoes t. */
+int othello_inverse_transform(int t);
+
+/* Set *out to o after transformation t. */
+void othello_transform(const othello_t *o, int t, othello_t *out);
+
+/* Set *out to the canonical form of o, which all its transformations share:
+   the one with the smallest (black disks, white disks). Returns the
+   smallest transformation that gives it. */
+int othello_canonical(const othello_t *o, othello_t *out);
+
+/* Search features, which can be turned off for benchmarking. */
+enum {
+        OTHELLO_SEARCH_HASH = 1 << 0,         /* Transposition table. */
+        OTHELLO_SEARCH_ORDERING = 1 << 1,     /* Heuristic move ordering. */
+        OTHELLO_SEARCH_PVS = 1 << 2,          /* Principal variation search. */
+        OTHELLO_SEARCH_ASPIRATION = 1 << 3,   /* Aspiration windows. */
+        OTHELLO_SEARCH_ENDGAME = 1 << 4,      /* Exact endgame solver. */
+        OTHELLO_SEARCH_INCREMENTAL = 1 << 5,  /* Incremental pattern codes. */
+        OTHELLO_SEARCH_STABILITY = 1 << 6,    /* Endgame stability cutoffs. */
+        OTHELLO_SEARCH_PROBCUT = 1 << 7,      /* Multi-ProbCut pruning. */
+        OTHELLO_SEARCH_BOOK = 1 << 8,         /* Opening book moves. */
+        OTHELLO_SEARCH_ALL = ~0
+};
+
+/* Search information, for tuning and monitoring. */
+#define OTHELLO_MAX_PLY 64
+
+typedef struct {
+        int depth;              /* Depth of the last completed iteration. */
+        int seldepth;           /* Deepest ply reached. */
+        int score;              /* Score of the best move for the side to
+                                   move, in evaluation units. */
+        bool exact;             /* The score is the final disk difference
+                                   (only its sign when solving for win,
+                                   loss or draw). */
+        int pv[OTHELLO_MAX_PLY]; /* Principal variation, as row * 8 + col,
+                                    with -1 for a pass. */
+        int pv_length;
+        double time;            /* Elapsed time in seconds. */
+        uint64_t nodes;         /* Positions visited. */
+        uint64_t evals;         /* Number of leaf evaluations. */
+        uint64_t tt_probes;     /* Transposition table lookups. */
+        uint64_t tt_hits;       /* Lookups that found the position. */
+        uint64_t cutoffs[OTHELLO_MAX_PLY];       /* Beta cutoffs by ply. */
+        uint64_t first_cutoffs[OTHELLO_MAX_PLY]; /* Of those, how many were
+                                                    by the first move. */
+} othello_search_info_t;
+
+/* Like othello_compute_move() and othello_negamax(), with only the given
+   search features, and filling in *info if it is non-NULL. */
+void othello_compute_move_stats(const othello_t *o, player_t p, int features,
+                                int *row, int *col,
+                                othello_search_info_t *info);
+int othello_negamax_stats(const othello_t *o, player_t p, int depth,
+                          int features, othello_search_info_t *info);
+/* Clear the hash tables. Searches of different positions may run in
+   parallel after the first call. */
+void othello_clear_hash(void);
+
+/* Like othello_compute_move_stats(), taking about ms milliseconds instead
+   of searching a fixed amount. The search deepens
+   until the next iteration is not expected to finish in time, and is
+   stopped mid-iteration if time runs out, playing the best move of the
+   deepest completed iteration. In the endgame, it plays a perfect move if
+   the game can be solved in time. */
+void othello_compute_move_timed(const othello_t *o, player_t p, int ms,
+                                int features, int *row, int *col,
+                                othello_search_info_t *info);
+
+/* A flag for another thread to stop a search with. */
+typedef volatile int othello_stop_t;
+
+/* Like othello_compute_move_timed(), or with ms 0, like
+   othello_compute_move_stats(), also stopping as soon as *stop is set by
+   another thread, if stop is non-NULL. A stopped search still plays the
+   best move of the deepest completed iteration, at least a shallow one. */
+void othello_compute_move_stoppable(const othello_t *o, player_t p, int ms,
+                                    int features, othello_stop_t *stop,
+                                    int *row, int *col,
+                                    othello_search_info_t *info);
+
+/* Pondering: searching on the opponent's time. Once the computer has
+   moved, othello_start_pondering() searches the position after the
+   opponent's expected reply in a background thread, until
+   othello_stop_pondering(). The hash tables keep what it found, so if the
+   opponent plays that move, the computer's next search gets deeper in the
+   same time; if not, little is lost.
+
+   Start pondering on o, with the opponent p to move, expecting move (as
+   row * 8 + col), or with -1, the move a shallow search prefers. The
+   search uses the given features. Returns false if there is nothing to
+   ponder on, such as when the computer would pass or play from the book,
+   or no thread could be started. Searches other than by the pondering
+   thread can run meanwhile, but the evaluator, book and other settings
+   must not change. */
+bool othello_start_pondering(const othello_t *o, player_t p, int move,
+                             int features);
+/* Stop pondering, if it is going on; call it before the computer's next
+   search. */
+void othello_stop_pondering(void);
+
+/* Multi-ProbCut: before searching a node to one of the listed depths, a
+   shallow search predicts the deep score as a * shallow score + b, with
+   standard deviation sigma, and the node is cut off if the prediction is
+   well outside the window. Parameters are per game phase, (empty cells -
+   1) / 10, and depth; othello_train probcut fits them. */
+#define OTHELLO_PROBCUT_PHASES 6
+#define OTHELLO_PROBCUT_MAX_DEPTH 14
+
+typedef struct {
+        int depth;              /* Of the shallow search; 0 to not prune. */
+        float a;
+        float b;
+        float sigma;
+} othello_probcut_t;
+
+/* Use the given parameters, in units of the current evaluation, or with
+   NULL, the built-in ones, which are only used with OTHELLO_EVAL_BUILTIN. */
+void othello_set_probcut(
+        const othello_probcut_t table[][OTHELLO_PROBCUT_MAX_DEPTH + 1]);
+
+/* Parallel search methods. */
+typedef enum {
+        OTHELLO_PARALLEL_LAZY_SMP,      /* Threads share a hash table. */
+        OTHELLO_PARALLEL_YBWC           /* Threads split the search tree. */
+} othello_parallel_t;
+
+/* Search to the given depth with the given number of threads. Returns the
+   best move as row * 8 + col. */
+int othello_iterative_negamax_mt(const othello_t *o, player_t p, int depth,
+                                 int threads, othello_parallel_t method,
+                                 othello_search_info_t *info);
+
+/* Like othello_solve(), with the given number of threads. */
+int othello_solve_mt(const othello_t *o, player_t p, othello_solve_mode_t mode,
+                     int threads, othello_parallel_t method, int *row,
+                     int *col, othello_search_info_t *info);
+
+/* Engines. An engine keeps its own hash tables, settings and pondering
+   thread from one search to the next, so that its searches build on each
+   other, and engines with different settings can search at the same time.
+   The functions above that take no engine are equivalent to using a single
+   global one with the default settings and the global evaluator and book;
+   the weights and network an engine evaluates with must still be loaded
+   globally. */
+typedef struct othello_engine othello_engine_t;
+
+typedef struct {
+        size_t hash_size;       /* Bytes for the transposition table. */
+        int threads;            /* Search threads, Lazy SMP if above 1. */
+        othello_evaluator_t evaluator;
+        const char *book;       /* Opening book file, or NULL for none. */
+        int features;           /* OTHELLO_SEARCH_* flags. */
+        bool huge_pages;        /* Ask for huge pages for the table. */
+} othello_engine_config_t;
+
+/* Fill in the settings of the global engine, with the current global
+   evaluator and no book. */
+void othello_engine_default_config(othello_engine_config_t *config);
+
+/* Create an engine with the given settings. Returns NULL if out of memory,
+   the book cannot be loaded or the evaluator has nothing loaded. */
+othello_engine_t *othello_engine_create(const othello_engine_config_t *config);
+void othello_engine_destroy(othello_engine_t *e);
+
+/* Clear the engine's hash tables. */
+void othello_engine_clear_hash(othello_engine_t *e);
+
+/* Like othello_compute_move_stoppable(), with the engine's settings. Stops
+   the engine pondering first. */
+void othello_engine_compute_move(othello_engine_t *e, const othello_t *o,
+                                 player_t p, int ms, othello_stop_t *stop,
+                                 int *row, int *col,
+                                 othello_search_info_t *info);
+
+/* Like othello_negamax_stats(), with the engine's settings. */
+int othello_engine_negamax(othello_engine_t *e, const othello_t *o,
+                           player_t p, int depth,
+                           othello_search_info_t *info);
+
+/* Like othello_start_pondering() and othello_stop_pondering(), with the
+   engine's settings. An engine ponders on one position at a time. */
+bool othello_engine_start_pondering(othello_engine_t *e, const othello_t *o,
+                                    player_t p, int move);
+void othello_engine_stop_pondering(othello_engine_t *e);
+
 #endif
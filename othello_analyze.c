@@ -0,0 +1,360 @@
+/* Analyse positions in bulk.
+
+   othello_analyze [-d depth | -t ms] [-j threads] [-w weights] [-n network]
+                   [-b book] [positions]
+
+   Each line of the file, or of the standard input, holds a position: 64
+   cells, row by row from a1, each 'x' for black, 'o' for white or '.' for
+   empty, then the side to move, 'x' or 'o'. Blank lines are skipped. For
+   each position, one line of JSON is written with the best move, its
+   score, the principal variation and the search statistics, in the same
+   order as the input. The search is to the given depth, for the given
+   time, or by default as othello_compute_move() searches.
+
+   Positions are searched by a pool of threads. Only a few lines per
+   thread are read ahead, so the input can be any length. Each thread has
+   its own engine, whose hash tables are cleared before each position, so
+   except with -t the results do not depend on the number of threads or
+   on timing. */
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "othello.h"
+
+#define MAX_THREADS 64
+#define MAX_LINE 256
+#define MAX_OUTPUT 2048
+#define SLOTS_PER_THREAD 4
+
+typedef enum {
+        SLOT_EMPTY,
+        SLOT_PENDING,           /* Read, waiting for a thread. */
+        SLOT_RUNNING,
+        SLOT_DONE               /* Analysed, waiting to be written. */
+} slot_state_t;
+
+typedef struct {
+        slot_state_t state;
+        long line;              /* Line number in the input. */
+        char input[MAX_LINE];
+        char output[MAX_OUTPUT];
+} slot_t;
+
+/* Lines are analysed in slots, used in turn as a ring. */
+static slot_t *slots;
+static int n_slots;
+static long n_read;             /* Positions read. */
+static long n_started;          /* Positions taken by a thread. */
+static bool eof;
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cond = PTHREAD_COND_INITIALIZER;
+
+static int depth;               /* Search depth, or 0. */
+static int move_time;           /* Milliseconds per position, or 0. */
+
+typedef struct {
+        othello_engine_t *engine;
+        pthread_t thread;
+} worker_t;
+
+static void usage(void)
+{
+        fprintf(stderr,
+                "usage: othello_analyze [-d depth | -t ms] [-j threads] "
+                "[-w weights] [-n network]\n"
+                "                       [-b book] [positions]\n");
+        exit(1);
+}
+
+static int parse_int(const char *s, int min, int max)
+{
+        char *end;
+        long x;
+
+        errno = 0;
+        x = strtol(s, &end, 10);
+        if (errno || *end || x < min || x > max) {
+                usage();
+        }
+
+        return (int)x;
+}
+
+/* Parse a position line. Returns false if it is not valid. */
+static bool parse_position(const char *s, othello_t *o, player_t *p)
+{
+        char cells[65];
+        int i;
+
+        while (*s == ' ' || *s == '\t') {
+                s++;
+        }
+        for (i = 0; i < 64; i++) {
+                if (s[i] != 'x' && s[i] != 'o' && s[i] != '.') {
+                        return false;
+                }
+                cells[i] = s[i];
+        }
+        cells[64] = '\0';
+        s += 64;
+
+        if (*s != ' ' && *s != '\t') {
+                return false;
+        }
+        while (*s == ' ' || *s == '\t') {
+                s++;
+        }
+        if (*s != 'x' && *s != 'o') {
+                return false;
+        }
+        *p = *s == 'x' ? PLAYER_BLACK : PLAYER_WHITE;
+        s++;
+        while (*s == ' ' || *s == '\t' || *s == '\r' || *s == '\n') {
+                s++;
+        }
+        if (*s != '\0') {
+                return false;
+        }
+
+        othello_from_string(cells, o);
+
+        return true;
+}
+
+static int print_move(char *s, int move)
+{
+        if (move == -1) {
+                return sprintf(s, "\"pass\"");
+        }
+
+        return sprintf(s, "\"%c%d\"", "abcdefgh"[move % 8], move / 8 + 1);
+}
+
+/* Analyse the slot's position with the engine, writing the result to the
+   slot's output. */
+static void analyze(othello_engine_t *e, slot_t *slot)
+{
+        othello_search_info_t info;
+        othello_t o;
+        player_t p;
+        char *s = slot->output;
+        int row, col, i, score;
+
+        s += sprintf(s, "{\"line\":%ld,", slot->line);
+        if (!parse_position(slot->input, &o, &p)) {
+                sprintf(s, "\"error\":\"invalid position\"}");
+                return;
+        }
+
+        if (!othello_has_valid_move(&o, p)) {
+                if (othello_has_valid_move(&o, p ^ 1)) {
+                        sprintf(s, "\"move\":\"pass\"}");
+                } else {
+                        score = othello_score(&o, p) -
+                                othello_score(&o, p ^ 1);
+                        sprintf(s, "\"move\":null,\"score\":%d,"
+                                "\"exact\":true}", score);
+                }
+                return;
+        }
+
+        othello_engine_clear_hash(e);
+        if (depth > 0) {
+                othello_engine_negamax(e, &o, p, depth, &info);
+        } else {
+                othello_engine_compute_move(e, &o, p, move_time, NULL, &row,
+                                            &col, &info);
+        }
+
+        s += sprintf(s, "\"move\":");
+        s += print_move(s, info.pv[0]);
+        s += sprintf(s, ",\"score\":%d,\"exact\":%s,\"depth\":%d,\"pv\":[",
+                     info.score, info.exact ? "true" : "false", info.depth);
+        for (i = 0; i < info.pv_length; i++) {
+                if (i > 0) {
+                        *s++ = ',';
+                }
+                s += print_move(s, info.pv[i]);
+        }
+        sprintf(s, "],\"nodes\":%llu,\"time\":%.3f}",
+                (unsigned long long)info.nodes, info.time);
+}
+
+static void *worker(void *arg)
+{
+        worker_t *w = arg;
+        slot_t *slot;
+
+        pthread_mutex_lock(&mutex);
+        while (true) {
+                while (n_started == n_read && !eof) {
+                        pthread_cond_wait(&cond, &mutex);
+                }
+                if (n_started == n_read) {
+                        break;
+                }
+                slot = &slots[n_started % n_slots];
+                slot->state = SLOT_RUNNING;
+                n_started++;
+                pthread_mutex_unlock(&mutex);
+
+                analyze(w->engine, slot);
+
+                pthread_mutex_lock(&mutex);
+                slot->state = SLOT_DONE;
+                pthread_cond_broadcast(&cond);
+        }
+        pthread_mutex_unlock(&mutex);
+
+        return NULL;
+}
+
+/* Write the results that are next in order. Called with the mutex held. */
+static void write_done(long *n_written)
+{
+        slot_t *slot;
+
+        while (*n_written < n_read &&
+               (slot = &slots[*n_written % n_slots])->state == SLOT_DONE) {
+                puts(slot->output);
+                slot->state = SLOT_EMPTY;
+                (*n_written)++;
+        }
+        fflush(stdout);
+}
+
+int main(int argc, char **argv)
+{
+        worker_t workers[MAX_THREADS];
+        othello_engine_config_t config;
+        const char *book = NULL;
+        char line[MAX_LINE];
+        long line_number = 0, n_written = 0;
+        int n_threads = 1, c, t;
+        bool too_long;
+        slot_t *slot;
+        size_t len;
+        FILE *f = stdin;
+
+        while ((c = getopt(argc, argv, "d:t:j:w:n:b:")) != -1) {
+                switch (c) {
+                case 'd': depth = parse_int(optarg, 1, 60); break;
+                case 't': move_time = parse_int(optarg, 1, 1000000000); break;
+                case 'j': n_threads = parse_int(optarg, 1, MAX_THREADS); break;
+                case 'w':
+                        if (!othello_load_weights(optarg)) {
+                                fprintf(stderr, "invalid weight file: %s\n",
+                                        optarg);
+                                return 1;
+                        }
+                        break;
+                case 'n':
+                        if (!othello_load_network(optarg)) {
+                                fprintf(stderr, "invalid network file: %s\n",
+                                        optarg);
+                                return 1;
+                        }
+                        break;
+                case 'b': book = optarg; break;
+                default: usage();
+                }
+        }
+        if (optind < argc - 1 || (depth > 0 && move_time > 0)) {
+                usage();
+        }
+        if (optind == argc - 1) {
+                f = fopen(argv[optind], "r");
+                if (f == NULL) {
+                        perror(argv[optind]);
+                        return 1;
+                }
+        }
+
+        othello_engine_default_config(&config);
+        config.book = book;
+        for (t = 0; t < n_threads; t++) {
+                workers[t].engine = othello_engine_create(&config);
+                if (workers[t].engine == NULL) {
+                        if (book != NULL) {
+                                fprintf(stderr, "invalid book file: %s\n",
+                                        book);
+                        } else {
+                                fprintf(stderr, "out of memory\n");
+                        }
+                        return 1;
+                }
+        }
+
+        n_slots = n_threads * SLOTS_PER_THREAD;
+        slots = calloc((size_t)n_slots, sizeof(*slots));
+        if (slots == NULL) {
+                fprintf(stderr, "out of memory\n");
+                return 1;
+        }
+        for (t = 0; t < n_threads; t++) {
+                if (pthread_create(&workers[t].thread, NULL, worker,
+                                   &workers[t]) != 0) {
+                        fprintf(stderr, "pthread_create failed\n");
+                        return 1;
+                }
+        }
+
+        while (fgets(line, sizeof(line), f) != NULL) {
+                line_number++;
+                len = strlen(line);
+                too_long = len == sizeof(line) - 1 && line[len - 1] != '\n';
+                if (too_long) {
+                        /* Skip the rest; it is reported as invalid. */
+                        while ((c = fgetc(f)) != EOF && c != '\n') {
+                        }
+                } else if (strspn(line, " \t\r\n") == len) {
+                        continue;
+                }
+
+                pthread_mutex_lock(&mutex);
+                while ((slot = &slots[n_read % n_slots])->state !=
+                       SLOT_EMPTY) {
+                        write_done(&n_written);
+                        if (slot->state != SLOT_EMPTY) {
+                                pthread_cond_wait(&cond, &mutex);
+                        }
+                }
+                slot->line = line_number;
+                strcpy(slot->input, too_long ? "" : line);
+                slot->state = SLOT_PENDING;
+                n_read++;
+                pthread_cond_broadcast(&cond);
+                write_done(&n_written);
+                pthread_mutex_unlock(&mutex);
+        }
+        if (ferror(f)) {
+                perror("read");
+        }
+
+        pthread_mutex_lock(&mutex);
+        eof = true;
+        pthread_cond_broadcast(&cond);
+        while (n_written < n_read) {
+                write_done(&n_written);
+                if (n_written < n_read) {
+                        pthread_cond_wait(&cond, &mutex);
+                }
+        }
+        pthread_mutex_unlock(&mutex);
+
+        for (t = 0; t < n_threads; t++) {
+                pthread_join(workers[t].thread, NULL);
+                othello_engine_destroy(workers[t].engine);
+        }
+        free(slots);
+        if (f != stdin) {
+                fclose(f);
+        }
+
+        return 0;
+}
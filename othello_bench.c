@@ -76,6 +76,11 @@ static void bench_iter_negamax(void)
         othello_iterative_negamax(&test_board, PLAYER_BLACK, 50000);
 }
 
+static void bench_canonical(void)
+{
+        othello_canonical(&test_board, &scratch_board);
+}
+
 static const struct {
         const char *name;
         void (*f)(void);
@@ -85,20 +90,24 @@ static const struct {
         { "eval",         bench_eval },
         { "negamax5",     bench_negamax },
         { "iter_negamax", bench_iter_negamax },
+        { "canonical",    bench_canonical },
 };
 
-static void run_benchmark(int benchmark_idx)
+static void run_benchmark(const char *name, void (*f)(void))
 {
         double start, stop;
         uint64_t iterations;
 
+        printf("%-20s", name);
+        fflush(stdout);
+
         running = true;
         iterations = 0;
         set_alarm(BENCH_TIME);
         start = get_time();
 
         while (running) {
-                (benchmarks[benchmark_idx].f)();
+                f();
                 ++iterations;
         }
 
@@ -107,17 +116,739 @@ static void run_benchmark(int benchmark_idx)
         printf("%12.0f /s\n", iterations / (stop - start));
 }
 
-int main()
+static othello_movegen_t movegen_impl;
+
+static void bench_movegen(void)
+{
+        uint64_t moves;
+
+        othello_generate_moves(&scratch_board, PLAYER_BLACK, movegen_impl,
+                               &moves);
+}
+
+static const struct {
+        const char *name;
+        othello_movegen_t impl;
+} movegen_impls[] = {
+        { "  dumb7fill",   OTHELLO_MOVEGEN_DUMB7FILL },
+        { "  kogge_stone", OTHELLO_MOVEGEN_KOGGE_STONE },
+        { "  sse2",        OTHELLO_MOVEGEN_SSE2 },
+        { "  avx2",        OTHELLO_MOVEGEN_AVX2 },
+};
+
+static othello_simd_t network_impl;
+
+static void bench_network_eval(void)
+{
+        int score;
+
+        othello_network_eval(&scratch_board, PLAYER_BLACK, network_impl,
+                             &score);
+}
+
+static const struct {
+        const char *name;
+        othello_simd_t impl;
+} network_impls[] = {
+        { "  network scalar", OTHELLO_SIMD_SCALAR },
+        { "  network sse2",   OTHELLO_SIMD_SSE2 },
+        { "  network avx2",   OTHELLO_SIMD_AVX2 },
+};
+
+static void bench_scratch_eval(void)
+{
+        othello_eval(&scratch_board, PLAYER_BLACK);
+}
+
+/* Evaluation speed. Unless a network file is given, use an all-zero network;
+   only the speed matters here. */
+static void eval_speed(const char *network_path)
 {
+        static const char path[] = "othello_bench_network.bin";
+        othello_network_t *net;
+        int score;
         size_t i;
 
+        if (network_path == NULL) {
+                net = calloc(1, sizeof(*net));
+                if (net == NULL || !othello_save_network(path, net)) {
+                        fprintf(stderr, "cannot write %s\n", path);
+                        exit(1);
+                }
+                free(net);
+                network_path = path;
+        }
+        if (!othello_load_network(network_path)) {
+                fprintf(stderr, "cannot load %s\n", network_path);
+                exit(1);
+        }
+
+        othello_set_evaluator(OTHELLO_EVAL_BUILTIN);
+        run_benchmark("  builtin", bench_scratch_eval);
+        othello_set_evaluator(OTHELLO_EVAL_NETWORK);
+        run_benchmark("  network", bench_scratch_eval);
+        for (i = 0; i < sizeof(network_impls) / sizeof(network_impls[0]);
+             i++) {
+                network_impl = network_impls[i].impl;
+                if (othello_network_eval(&scratch_board, PLAYER_BLACK,
+                                         network_impl, &score)) {
+                        run_benchmark(network_impls[i].name,
+                                      bench_network_eval);
+                }
+        }
+
+        if (network_path == path) {
+                othello_unload_network();
+                remove(path);
+        }
+}
+
+#define MATCH_OPENINGS 50
+#define MATCH_RANDOM_MOVES 8
+#define MATCH_BUDGET 20000
+
+/* How one side of a match searches. */
+typedef struct {
+        othello_evaluator_t evaluator;
+        int features;
+        int ms;                 /* Time per move, or 0 to search
+                                   MATCH_BUDGET evaluations. */
+} match_player_t;
+
+/* Play a game from o between the given players, indexed by colour. Returns
+   black's final disk difference. */
+static int play_match_game(othello_t o, player_t p,
+                           const match_player_t *const *players)
+{
+        int move, row, col;
+
+        while (true) {
+                if (!othello_has_valid_move(&o, p)) {
+                        p ^= 1;
+                        if (!othello_has_valid_move(&o, p)) {
+                                break;
+                        }
+                }
+
+                /* The hash table holds scores of the other player. */
+                othello_set_evaluator(players[p]->evaluator);
+                othello_clear_hash();
+                if (players[p]->ms > 0) {
+                        othello_compute_move_timed(&o, p, players[p]->ms,
+                                                   players[p]->features,
+                                                   &row, &col, NULL);
+                } else {
+                        move = othello_iterative_negamax(&o, p, MATCH_BUDGET);
+                        row = move / 8;
+                        col = move % 8;
+                }
+                othello_make_move(&o, p, row, col);
+                p ^= 1;
+        }
+
+        return othello_score(&o, PLAYER_BLACK) -
+               othello_score(&o, PLAYER_WHITE);
+}
+
+/* Play a against b from random openings, each with both colours. */
+static void strength_match(const char *name, const match_player_t *a,
+                           const match_player_t *b, int openings)
+{
+        const match_player_t *players[2];
+        int i, j, row, col, diff, wins = 0, draws = 0, losses = 0;
+        long total = 0;
+        othello_t o;
+        player_t p;
+
+        srand(1);
+        for (i = 0; i < openings; i++) {
+                othello_init(&o);
+                p = PLAYER_BLACK;
+                for (j = 0; j < MATCH_RANDOM_MOVES; j++) {
+                        othello_compute_random_move(&o, p, &row, &col);
+                        othello_make_move(&o, p, row, col);
+                        p ^= 1;
+                }
+
+                for (j = 0; j < 2; j++) {
+                        players[PLAYER_BLACK] = j ? b : a;
+                        players[PLAYER_WHITE] = j ? a : b;
+                        diff = play_match_game(o, p, players);
+                        diff = j ? -diff : diff;
+                        total += diff;
+                        wins += diff > 0;
+                        draws += diff == 0;
+                        losses += diff < 0;
+                }
+        }
+
+        printf("%s: %d wins, %d draws, %d losses, %+.1f disks per game\n",
+               name, wins, draws, losses, (double)total / (2 * openings));
+}
+
+static const char midgame_board[] =
+        " abcdefgh \n"
+        "1...x....1\n"
+        "2o.x.x...2\n"
+        "3.ooooxo.3\n"
+        "4xooxxxx.4\n"
+        "5o.ooox..5\n"
+        "6..o.o...6\n"
+        "7........7\n"
+        "8........8\n"
+        " abcdefgh \n";
+
+/* Search features, cumulatively enabled. */
+static const struct {
+        const char *name;
+        int features;
+} configs[] = {
+        { "base",        0 },
+        { "+hash",       OTHELLO_SEARCH_HASH },
+        { "+ordering",   OTHELLO_SEARCH_HASH | OTHELLO_SEARCH_ORDERING },
+        { "+pvs",        OTHELLO_SEARCH_HASH | OTHELLO_SEARCH_ORDERING |
+                         OTHELLO_SEARCH_PVS },
+        { "+aspiration", OTHELLO_SEARCH_ALL & ~OTHELLO_SEARCH_PROBCUT },
+        { "+probcut",    OTHELLO_SEARCH_ALL },
+};
+
+#define FIXED_DEPTH 7
+
+/* Percentage of beta cutoffs caused by the first move searched. */
+static double first_cutoff_rate(const othello_search_info_t *info)
+{
+        uint64_t cutoffs = 0, first = 0;
+        int i;
+
+        for (i = 0; i < OTHELLO_MAX_PLY; i++) {
+                cutoffs += info->cutoffs[i];
+                first += info->first_cutoffs[i];
+        }
+
+        return cutoffs ? 100.0 * first / cutoffs : 0.0;
+}
+
+static void search_stats(const char *name, const othello_t *o, player_t p)
+{
+        othello_search_info_t move_stats, depth_stats;
+        int row, col;
+        size_t i;
+
+        for (i = 0; i < sizeof(configs) / sizeof(configs[0]); i++) {
+                othello_clear_hash();
+                othello_negamax_stats(o, p, FIXED_DEPTH, configs[i].features,
+                                      &depth_stats);
+                othello_clear_hash();
+                othello_compute_move_stats(o, p, configs[i].features,
+                                           &row, &col, &move_stats);
+
+                printf("%-8s%-12s %9llu %5d %9llu %9llu %5.1f%% %5.1f%%\n",
+                       i == 0 ? name : "", configs[i].name,
+                       (unsigned long long)depth_stats.nodes,
+                       move_stats.depth,
+                       (unsigned long long)move_stats.nodes,
+                       (unsigned long long)move_stats.evals,
+                       move_stats.tt_probes ? 100.0 * move_stats.tt_hits /
+                       move_stats.tt_probes : 0.0,
+                       first_cutoff_rate(&move_stats));
+        }
+}
+
+/* Print the search information of a move search: the totals, the
+   principal variation, and the cutoffs at each ply. */
+static void search_info(const othello_t *o, player_t p)
+{
+        othello_search_info_t info;
+        int row, col, i;
+
+        othello_clear_hash();
+        othello_compute_move_stats(o, p, OTHELLO_SEARCH_ALL, &row, &col,
+                                   &info);
+
+        printf("depth %d, seldepth %d, score %+d%s, %.2fs, "
+               "%llu nodes, %llu evals\npv", info.depth, info.seldepth,
+               info.score, info.exact ? " (exact)" : "", info.time,
+               (unsigned long long)info.nodes,
+               (unsigned long long)info.evals);
+        for (i = 0; i < info.pv_length; i++) {
+                if (info.pv[i] == -1) {
+                        printf(" pass");
+                } else {
+                        printf(" %c%d", "abcdefgh"[info.pv[i] % 8],
+                               info.pv[i] / 8 + 1);
+                }
+        }
+
+        printf("\n\n%-20s %9s %9s\n", "ply", "cutoffs", "1st");
+        for (i = 0; i < OTHELLO_MAX_PLY && i < info.seldepth; i++) {
+                printf("%-20d %9llu %8.1f%%\n", i,
+                       (unsigned long long)info.cutoffs[i],
+                       info.cutoffs[i] ? 100.0 * info.first_cutoffs[i] /
+                       info.cutoffs[i] : 0.0);
+        }
+}
+
+#define INCREMENTAL_DEPTH 9
+
+/* Compare computing the evaluation's state at each leaf with updating it as
+   moves are made. The weights are all zero; only the speed matters here. */
+static void incremental_search(const othello_t *o, player_t p)
+{
+        static const char weights_path[] = "othello_bench_weights.bin";
+        static const char network_path[] = "othello_bench_network.bin";
+        static const struct {
+                const char *name;
+                othello_evaluator_t evaluator;
+                int features;
+        } configs[] = {
+                { "patterns",    OTHELLO_EVAL_PATTERNS,
+                  OTHELLO_SEARCH_ALL & ~OTHELLO_SEARCH_INCREMENTAL },
+                { " incremental", OTHELLO_EVAL_PATTERNS, OTHELLO_SEARCH_ALL },
+                { "network",     OTHELLO_EVAL_NETWORK,
+                  OTHELLO_SEARCH_ALL & ~OTHELLO_SEARCH_INCREMENTAL },
+                { " incremental", OTHELLO_EVAL_NETWORK, OTHELLO_SEARCH_ALL },
+        };
+
+        othello_search_info_t stats;
+        othello_network_t *net;
+        double start, elapsed;
+        int16_t *weights;
+        size_t i;
+
+        weights = calloc(OTHELLO_NUM_WEIGHTS, sizeof(*weights));
+        net = calloc(1, sizeof(*net));
+        if (weights == NULL || net == NULL ||
+            !othello_save_weights(weights_path, weights) ||
+            !othello_load_weights(weights_path) ||
+            !othello_save_network(network_path, net) ||
+            !othello_load_network(network_path)) {
+                fprintf(stderr, "cannot write and load %s and %s\n",
+                        weights_path, network_path);
+                exit(1);
+        }
+        free(weights);
+        free(net);
+
+        printf("\n%-20s %9s %12s\n", "evaluation", "time", "evals/s");
+        for (i = 0; i < sizeof(configs) / sizeof(configs[0]); i++) {
+                othello_set_evaluator(configs[i].evaluator);
+                othello_clear_hash();
+                start = get_time();
+                othello_negamax_stats(o, p, INCREMENTAL_DEPTH,
+                                      configs[i].features, &stats);
+                elapsed = get_time() - start;
+
+                printf("%-20s %8.2fs %12.0f\n", configs[i].name, elapsed,
+                       stats.evals / elapsed);
+        }
+
+        othello_unload_weights();
+        othello_unload_network();
+        remove(weights_path);
+        remove(network_path);
+}
+
+#define SCALING_DEPTH 10
+
+static const char endgame_board[] =
+        " abcdefgh \n"
+        "1xoooo...1\n"
+        "2oxxoox..2\n"
+        "3xxxxoxo.3\n"
+        "4oxxoxoo.4\n"
+        "5xxoxxoo.5\n"
+        "6xxxxoxo.6\n"
+        "7..xxxo..7\n"
+        "8..ooo...8\n"
+        " abcdefgh \n";
+
+static void thread_scaling(const othello_t *o, player_t p, bool solving)
+{
+        static const struct {
+                const char *name;
+                othello_parallel_t method;
+        } methods[] = {
+                { "Lazy SMP", OTHELLO_PARALLEL_LAZY_SMP },
+                { "YBWC",     OTHELLO_PARALLEL_YBWC },
+        };
+
+        othello_search_info_t stats;
+        double start, elapsed;
+        long max_threads;
+        int threads, row, col;
+        size_t i;
+
+        max_threads = sysconf(_SC_NPROCESSORS_ONLN);
+        max_threads = max_threads < 8 ? 8 : max_threads;
+
+        printf("\n%-10s%-10s %9s %12s\n", "method", "threads", "time",
+               "nodes/s");
+        for (i = 0; i < sizeof(methods) / sizeof(methods[0]); i++) {
+                for (threads = 1; threads <= max_threads; threads *= 2) {
+                        othello_clear_hash();
+                        start = get_time();
+                        if (solving) {
+                                othello_solve_mt(o, p, OTHELLO_SOLVE_EXACT,
+                                                 threads, methods[i].method,
+                                                 &row, &col, &stats);
+                        } else {
+                                othello_iterative_negamax_mt(o, p,
+                                        SCALING_DEPTH, threads,
+                                        methods[i].method, &stats);
+                        }
+                        elapsed = get_time() - start;
+
+                        printf("%-10s%-10d %8.2fs %12.0f\n",
+                               threads == 1 ? methods[i].name : "", threads,
+                               elapsed, stats.nodes / elapsed);
+                }
+        }
+}
+
+/* Play random moves until the given number of cells are empty, starting
+   again if the game ends first. */
+static void random_position(int empties, othello_t *o, player_t *p)
+{
+        int row, col;
+
+        do {
+                othello_init(o);
+                *p = PLAYER_BLACK;
+                while (othello_has_valid_move(o, *p) &&
+                       64 - othello_score(o, PLAYER_BLACK) -
+                       othello_score(o, PLAYER_WHITE) > empties) {
+                        othello_compute_random_move(o, *p, &row, &col);
+                        othello_make_move(o, *p, row, col);
+                        if (othello_has_valid_move(o, *p ^ 1)) {
+                                *p ^= 1;
+                        }
+                }
+        } while (!othello_has_valid_move(o, *p));
+}
+
+#define STABILITY_POSITIONS 10
+#define STABILITY_EMPTIES 18
+
+/* Solve positions from random games, with and without cutting off on
+   stable disks. */
+static void stability_cutoffs(void)
+{
+        static const struct {
+                const char *name;
+                int features;
+        } configs[] = {
+                { "no cutoffs",
+                  OTHELLO_SEARCH_ALL & ~OTHELLO_SEARCH_STABILITY },
+                { "stability", OTHELLO_SEARCH_ALL },
+        };
+
+        othello_t positions[STABILITY_POSITIONS];
+        player_t players[STABILITY_POSITIONS];
+        othello_search_info_t stats;
+        double start, elapsed;
+        uint64_t nodes;
+        int i, row, col;
+        size_t j;
+
+        srand(1);
+        for (i = 0; i < STABILITY_POSITIONS; i++) {
+                random_position(STABILITY_EMPTIES, &positions[i],
+                                &players[i]);
+        }
+
+        printf("\n%-20s %9s %12s %12s\n", "solver", "time", "nodes",
+               "nodes/s");
+        for (j = 0; j < sizeof(configs) / sizeof(configs[0]); j++) {
+                nodes = 0;
+                start = get_time();
+                for (i = 0; i < STABILITY_POSITIONS; i++) {
+                        othello_clear_hash();
+                        othello_compute_move_stats(&positions[i], players[i],
+                                                   configs[j].features, &row,
+                                                   &col, &stats);
+                        nodes += stats.nodes;
+                }
+                elapsed = get_time() - start;
+
+                printf("%-20s %8.2fs %12llu %12.0f\n", configs[j].name,
+                       elapsed, (unsigned long long)nodes, nodes / elapsed);
+        }
+}
+
+#define PROBCUT_POSITIONS 10
+#define PROBCUT_EMPTIES 40
+#define PROBCUT_MS 100
+#define PROBCUT_MATCH_OPENINGS 10
+#define PROBCUT_MATCH_MS 20
+
+/* Compare the depth reached in a fixed time with and without Multi-ProbCut,
+   and play them against each other. */
+static void selective_search(void)
+{
+        static const match_player_t players[] = {
+                { OTHELLO_EVAL_BUILTIN,
+                  OTHELLO_SEARCH_ALL & ~OTHELLO_SEARCH_PROBCUT,
+                  PROBCUT_MATCH_MS },
+                { OTHELLO_EVAL_BUILTIN, OTHELLO_SEARCH_ALL, PROBCUT_MATCH_MS },
+        };
+        static const char *const names[] = { "full width", "probcut" };
+
+        othello_t positions[PROBCUT_POSITIONS];
+        player_t sides[PROBCUT_POSITIONS];
+        othello_search_info_t info;
+        uint64_t nodes;
+        int i, j, row, col, depth;
+
+        srand(1);
+        for (i = 0; i < PROBCUT_POSITIONS; i++) {
+                random_position(PROBCUT_EMPTIES, &positions[i], &sides[i]);
+        }
+
+        printf("\n%-20s %9s %12s\n", "search", "depth", "nodes");
+        for (j = 0; j < 2; j++) {
+                depth = 0;
+                nodes = 0;
+                for (i = 0; i < PROBCUT_POSITIONS; i++) {
+                        othello_clear_hash();
+                        othello_compute_move_timed(&positions[i], sides[i],
+                                                   PROBCUT_MS,
+                                                   players[j].features, &row,
+                                                   &col, &info);
+                        depth += info.depth;
+                        nodes += info.nodes;
+                }
+                printf("%-20s %9.1f %12llu\n", names[j],
+                       (double)depth / PROBCUT_POSITIONS,
+                       (unsigned long long)nodes / PROBCUT_POSITIONS);
+        }
+
+        printf("\nmatch, %d openings, %d ms per move:\n",
+               PROBCUT_MATCH_OPENINGS, PROBCUT_MATCH_MS);
+        strength_match("probcut vs full", &players[1], &players[0],
+                       PROBCUT_MATCH_OPENINGS);
+}
+
+#define PONDER_POSITIONS 10
+#define PONDER_EMPTIES 40
+#define PONDER_MS 100
+
+/* After a timed move, let the opponent think for as long, then compare the
+   depth of the next timed move without pondering meanwhile, and with
+   pondering when the opponent plays the expected reply or another one. */
+static void pondering(void)
+{
+        static const char *const names[] = {
+                "no pondering", "expected reply", "other reply"
+        };
+
+        othello_t positions[PONDER_POSITIONS], o;
+        player_t sides[PONDER_POSITIONS], p;
+        othello_search_info_t info;
+        int i, j, n, row, col, move, expected, depth;
+
+        srand(1);
+        for (i = 0; i < PONDER_POSITIONS; i++) {
+                random_position(PONDER_EMPTIES, &positions[i], &sides[i]);
+        }
+
+        printf("\n%-20s %9s %9s\n", "next move", "depth", "positions");
+        for (j = 0; j < 3; j++) {
+                depth = 0;
+                n = 0;
+                for (i = 0; i < PONDER_POSITIONS; i++) {
+                        o = positions[i];
+                        p = sides[i];
+                        othello_clear_hash();
+                        othello_compute_move_timed(&o, p, PONDER_MS,
+                                                   OTHELLO_SEARCH_ALL, &row,
+                                                   &col, &info);
+                        othello_make_move(&o, p, row, col);
+                        if (!othello_has_valid_move(&o, p ^ 1) ||
+                            info.pv_length < 2) {
+                                continue;
+                        }
+
+                        /* The opponent's reply. */
+                        expected = info.pv[1];
+                        move = expected;
+                        if (j == 2) {
+                                for (move = 0; move < 64 &&
+                                     (move == expected ||
+                                      !othello_is_valid_move(&o, p ^ 1,
+                                                             move / 8,
+                                                             move % 8));
+                                     move++) {
+                                }
+                                if (move == 64) {
+                                        continue;
+                                }
+                        }
+
+                        if (j > 0) {
+                                othello_start_pondering(&o, p ^ 1, expected,
+                                                        OTHELLO_SEARCH_ALL);
+                        }
+                        usleep(PONDER_MS * 1000);
+                        othello_stop_pondering();
+
+                        othello_make_move(&o, p ^ 1, move / 8, move % 8);
+                        if (!othello_has_valid_move(&o, p)) {
+                                continue;
+                        }
+                        othello_compute_move_timed(&o, p, PONDER_MS,
+                                                   OTHELLO_SEARCH_ALL, &row,
+                                                   &col, &info);
+                        depth += info.depth;
+                        n++;
+                }
+                printf("%-20s %9.1f %9d\n", names[j],
+                       n > 0 ? (double)depth / n : 0.0, n);
+        }
+}
+
+/* Leaf counts from the initial position, as published for othello perft. */
+static const uint64_t PERFT_COUNTS[] = {
+        1, 4, 12, 56, 244, 1396, 8200, 55092, 390216, 3005288, 24571284,
+        212258800, 1939886636, 18429641748ULL
+};
+
+#define PERFT_MAX_DEPTH \
+        ((int)(sizeof(PERFT_COUNTS) / sizeof(PERFT_COUNTS[0])) - 1)
+#define PERFT_DEPTH 11
+
+/* Count the leaves from the initial position to each depth, making every
+   move and then counting the last moves in bulk, and check them. Returns
+   false on a wrong count. */
+static bool perft(int max_depth)
+{
+        uint64_t counts[2];
+        double times[2], start;
+        othello_t o;
+        bool ok = true;
+        int depth, bulk;
+
+        othello_init(&o);
+        printf("%-6s %14s %9s %14s %9s %14s\n", "depth", "leaves", "time",
+               "leaves/s", "bulk", "leaves/s");
+        for (depth = 1; depth <= max_depth; depth++) {
+                for (bulk = 0; bulk < 2; bulk++) {
+                        start = get_time();
+                        counts[bulk] = othello_perft(&o, PLAYER_BLACK, depth,
+                                                     bulk);
+                        times[bulk] = get_time() - start;
+                }
+
+                printf("%-6d %14llu", depth, (unsigned long long)counts[0]);
+                for (bulk = 0; bulk < 2; bulk++) {
+                        /* Too short to time. */
+                        if (times[bulk] < 0.01) {
+                                printf(" %9s %14s", "-", "-");
+                        } else {
+                                printf(" %8.2fs %14.0f", times[bulk],
+                                       counts[bulk] / times[bulk]);
+                        }
+                }
+                if (counts[0] != PERFT_COUNTS[depth] ||
+                    counts[1] != PERFT_COUNTS[depth]) {
+                        printf("  expected %llu",
+                               (unsigned long long)PERFT_COUNTS[depth]);
+                        ok = false;
+                }
+                printf("\n");
+        }
+
+        return ok;
+}
+
+int main(int argc, char **argv)
+{
+        static const match_player_t builtin = {
+                OTHELLO_EVAL_BUILTIN, OTHELLO_SEARCH_ALL, 0
+        };
+        static const match_player_t network = {
+                OTHELLO_EVAL_NETWORK, OTHELLO_SEARCH_ALL, 0
+        };
+        othello_t o;
+        uint64_t moves;
+        size_t i;
+        int depth;
+
+        if (argc > 1 && !strcmp(argv[1], "perft")) {
+                depth = argc > 2 ? atoi(argv[2]) : PERFT_DEPTH;
+                if (argc > 3 || depth < 1 || depth > PERFT_MAX_DEPTH) {
+                        fprintf(stderr, "usage: %s perft [depth], with "
+                                "depth from 1 to %d\n", argv[0],
+                                PERFT_MAX_DEPTH);
+                        return 1;
+                }
+                return perft(depth) ? 0 : 1;
+        }
+        if (argc > 2) {
+                fprintf(stderr, "usage: %s [network]\n"
+                        "       %s perft [depth]\n", argv[0], argv[0]);
+                return 1;
+        }
+
         othello_init(&test_board);
 
         for (i = 0; i < sizeof(benchmarks) / sizeof(benchmarks[0]); i++) {
-                printf("%-20s", benchmarks[i].name);
-                fflush(stdout);
-                run_benchmark(i);
+                run_benchmark(benchmarks[i].name, benchmarks[i].f);
+        }
+
+        printf("\nmove generation (midgame):\n");
+        othello_from_string(midgame_board, &scratch_board);
+        for (i = 0; i < sizeof(movegen_impls) / sizeof(movegen_impls[0]);
+             i++) {
+                movegen_impl = movegen_impls[i].impl;
+                if (othello_generate_moves(&scratch_board, PLAYER_BLACK,
+                                           movegen_impl, &moves)) {
+                        run_benchmark(movegen_impls[i].name, bench_movegen);
+                }
         }
 
+        printf("\nevaluation (midgame):\n");
+        eval_speed(argc == 2 ? argv[1] : NULL);
+        if (argc == 2) {
+                printf("\nmatch, %d openings, %d evals per move:\n",
+                       MATCH_OPENINGS, MATCH_BUDGET);
+                strength_match("network vs builtin", &network, &builtin,
+                               MATCH_OPENINGS);
+                othello_set_evaluator(OTHELLO_EVAL_BUILTIN);
+        }
+
+        printf("\n%-20s %8s%d %5s %9s %9s %6s %6s\n", "search", "nodes@",
+               FIXED_DEPTH, "depth", "nodes", "evals", "tt hit", "1st");
+        search_stats("initial", &test_board, PLAYER_BLACK);
+        othello_from_string(midgame_board, &o);
+        search_stats("midgame", &o, PLAYER_BLACK);
+
+        printf("\nsearch information, midgame:\n");
+        search_info(&o, PLAYER_BLACK);
+
+        printf("\nsearch with state updates, midgame to depth %d:",
+               INCREMENTAL_DEPTH);
+        incremental_search(&o, PLAYER_BLACK);
+
+        printf("\nparallel search, midgame to depth %d:", SCALING_DEPTH);
+        thread_scaling(&o, PLAYER_BLACK, false);
+
+        othello_from_string(endgame_board, &o);
+        printf("\nparallel solve, endgame with %d empties:",
+               64 - othello_score(&o, PLAYER_BLACK) -
+               othello_score(&o, PLAYER_WHITE));
+        thread_scaling(&o, PLAYER_BLACK, true);
+
+        printf("\nsolve, %d random positions with %d empties:",
+               STABILITY_POSITIONS, STABILITY_EMPTIES);
+        stability_cutoffs();
+
+        printf("\nselective search, %d random positions with %d empties, "
+               "%d ms:", PROBCUT_POSITIONS, PROBCUT_EMPTIES, PROBCUT_MS);
+        selective_search();
+
+        printf("\npondering, %d random positions with %d empties, %d ms:",
+               PONDER_POSITIONS, PONDER_EMPTIES, PONDER_MS);
+        pondering();
+
         return 0;
 }
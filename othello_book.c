@@ -0,0 +1,186 @@
+/* Build an opening book with deep searches.
+
+   othello_book [-p plies] [-x width] [-m margin] [-d depth] [-w weights]
+                [-n network] book
+
+   Starting from the initial position, every move of a position is scored
+   by a search to the given depth, and the best ones, up to width of them
+   and within margin of the best, are expanded in turn, until the given
+   number of plies has been played. Positions already in the book are not
+   searched again unless the depth is greater, so running it again with
+   more plies or a greater width extends the book. */
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "othello.h"
+
+typedef struct {
+        int plies;
+        int width;
+        int margin;
+        int depth;
+        int searched;           /* Positions searched so far. */
+} build_t;
+
+static void usage(void)
+{
+        fprintf(stderr,
+                "usage: othello_book [-p plies] [-x width] [-m margin] "
+                "[-d depth] [-w weights]\n"
+                "                    [-n network] book\n");
+        exit(1);
+}
+
+static int parse_int(const char *s, int min, int max)
+{
+        char *end;
+        long x;
+
+        errno = 0;
+        x = strtol(s, &end, 10);
+        if (errno || *end || x < min || x > max) {
+                usage();
+        }
+
+        return (int)x;
+}
+
+/* Score each of p's moves with a search to the given depth, keeping the
+   best, best first. */
+static void score_moves(const othello_t *o, player_t p, int depth,
+                        othello_book_moves_t *moves)
+{
+        othello_t child;
+        int row, col, i, score;
+
+        moves->n_moves = 0;
+        moves->depth = depth;
+        for (row = 0; row < 8; row++) {
+                for (col = 0; col < 8; col++) {
+                        if (!othello_is_valid_move(o, p, row, col)) {
+                                continue;
+                        }
+                        child = *o;
+                        othello_make_move(&child, p, row, col);
+                        score = -othello_negamax_stats(&child, p ^ 1,
+                                                       depth - 1,
+                                                       OTHELLO_SEARCH_ALL,
+                                                       NULL);
+
+                        /* Insert it, dropping the worst if there are too
+                           many. */
+                        i = moves->n_moves < OTHELLO_BOOK_MOVES ?
+                            moves->n_moves++ : OTHELLO_BOOK_MOVES;
+                        for (; i > 0 && moves->scores[i - 1] < score; i--) {
+                                if (i < OTHELLO_BOOK_MOVES) {
+                                        moves->moves[i] = moves->moves[i - 1];
+                                        moves->scores[i] =
+                                                moves->scores[i - 1];
+                                }
+                        }
+                        if (i < OTHELLO_BOOK_MOVES) {
+                                moves->moves[i] = row * 8 + col;
+                                moves->scores[i] = score;
+                        }
+                }
+        }
+}
+
+static void expand(build_t *b, const othello_t *o, player_t p, int plies)
+{
+        othello_book_moves_t moves;
+        othello_t child;
+        int i, move;
+
+        if (plies == 0) {
+                return;
+        }
+        if (!othello_has_valid_move(o, p)) {
+                p ^= 1;
+                if (!othello_has_valid_move(o, p)) {
+                        return;
+                }
+        }
+
+        if (!othello_book_lookup(o, p, &moves) || moves.depth < b->depth) {
+                score_moves(o, p, b->depth, &moves);
+                if (!othello_book_add(o, p, &moves)) {
+                        fprintf(stderr, "out of memory\n");
+                        exit(1);
+                }
+                if (++b->searched % 10 == 0) {
+                        printf("%d positions searched\n", b->searched);
+                        fflush(stdout);
+                }
+        }
+
+        for (i = 0; i < moves.n_moves && i < b->width &&
+             moves.scores[i] >= moves.scores[0] - b->margin; i++) {
+                move = moves.moves[i];
+                child = *o;
+                othello_make_move(&child, p, move / 8, move % 8);
+                expand(b, &child, p ^ 1, plies - 1);
+        }
+}
+
+int main(int argc, char **argv)
+{
+        build_t b = { 8, 2, 8, 10, 0 };
+        othello_t o;
+        FILE *f;
+        int c;
+
+        while ((c = getopt(argc, argv, "p:x:m:d:w:n:")) != -1) {
+                switch (c) {
+                case 'p': b.plies = parse_int(optarg, 1, 60); break;
+                case 'x': b.width = parse_int(optarg, 1,
+                                              OTHELLO_BOOK_MOVES); break;
+                case 'm': b.margin = parse_int(optarg, 0, 1000000); break;
+                case 'd': b.depth = parse_int(optarg, 1, 60); break;
+                case 'w':
+                        if (!othello_load_weights(optarg)) {
+                                fprintf(stderr, "invalid weight file: %s\n",
+                                        optarg);
+                                return 1;
+                        }
+                        break;
+                case 'n':
+                        if (!othello_load_network(optarg)) {
+                                fprintf(stderr, "invalid network file: %s\n",
+                                        optarg);
+                                return 1;
+                        }
+                        break;
+                default: usage();
+                }
+        }
+        if (optind != argc - 1) {
+                usage();
+        }
+
+        /* Extend an existing book. */
+        f = fopen(argv[optind], "rb");
+        if (f != NULL) {
+                fclose(f);
+                if (!othello_load_book(argv[optind])) {
+                        fprintf(stderr, "invalid book file: %s\n",
+                                argv[optind]);
+                        return 1;
+                }
+        }
+
+        othello_init(&o);
+        expand(&b, &o, PLAYER_BLACK, b.plies);
+        printf("%d positions searched\n", b.searched);
+
+        if (!othello_save_book(argv[optind])) {
+                perror(argv[optind]);
+                return 1;
+        }
+
+        return 0;
+}
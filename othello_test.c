@@ -2,8 +2,22 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
+#include <time.h>
 #include "othello.h"
 
+/* A midgame position shared by the search tests. */
+static const char midgame_board[] =
+        " abcdefgh \n"
+        "1...x....1\n"
+        "2o.x.x...2\n"
+        "3.ooooxo.3\n"
+        "4xooxxxx.4\n"
+        "5o.ooox..5\n"
+        "6..o.o...6\n"
+        "7........7\n"
+        "8........8\n"
+        " abcdefgh \n";
+
 static void check_moves(const char *board_str, player_t p,
                         const char *expected_moves)
 {
@@ -329,6 +343,146 @@ static void test_resolve_no_wrap_r(void)
         check_resolve(before, after, PLAYER_BLACK, 3, 6);
 }
 
+static uint64_t xorshift64(uint64_t *state)
+{
+        *state ^= *state << 13;
+        *state ^= *state >> 7;
+        *state ^= *state << 17;
+
+        return *state;
+}
+
+static void test_gen_moves_impls(void)
+{
+        /* Check that the move generation implementations agree on random
+           positions. */
+
+        static const othello_movegen_t impls[] = {
+                OTHELLO_MOVEGEN_DEFAULT,
+                OTHELLO_MOVEGEN_KOGGE_STONE,
+                OTHELLO_MOVEGEN_SSE2,
+                OTHELLO_MOVEGEN_AVX2
+        };
+
+        othello_t o;
+        uint64_t state = 88172645463325252ULL, a, b, expected, moves;
+        size_t i;
+        int n, p;
+
+        for (n = 0; n < 100000; n++) {
+                a = xorshift64(&state);
+                b = xorshift64(&state);
+
+                o.disks[PLAYER_BLACK] = a & b;
+                o.disks[PLAYER_WHITE] = a & ~b;
+
+                for (p = PLAYER_BLACK; p <= PLAYER_WHITE; p++) {
+                        othello_generate_moves(&o, (player_t)p,
+                                               OTHELLO_MOVEGEN_DUMB7FILL,
+                                               &expected);
+                        for (i = 0; i < sizeof(impls) / sizeof(impls[0]);
+                             i++) {
+                                if (othello_generate_moves(&o, (player_t)p,
+                                                           impls[i], &moves) &&
+                                    moves != expected) {
+                                        fprintf(stderr, "implementation %d "
+                                                "disagrees\n", (int)impls[i]);
+                                        exit(EXIT_FAILURE);
+                                }
+                        }
+                }
+        }
+}
+
+/* Count leaves like othello_perft(), with the public functions only. */
+static uint64_t reference_perft(const othello_t *o, player_t p, int depth)
+{
+        othello_t child;
+        uint64_t n = 0;
+        int row, col;
+
+        if (depth == 0) {
+                return 1;
+        }
+        if (!othello_has_valid_move(o, p)) {
+                if (!othello_has_valid_move(o, p ^ 1)) {
+                        return 1;
+                }
+                return reference_perft(o, p ^ 1, depth - 1);
+        }
+        for (row = 0; row < 8; row++) {
+                for (col = 0; col < 8; col++) {
+                        if (othello_is_valid_move(o, p, row, col)) {
+                                child = *o;
+                                othello_make_move(&child, p, row, col);
+                                n += reference_perft(&child, p ^ 1,
+                                                     depth - 1);
+                        }
+                }
+        }
+
+        return n;
+}
+
+static void test_perft(void)
+{
+        /* The published counts from the initial position, and agreement
+           with a simple count, passes and finished games included, in
+           positions from random games. */
+
+        static const uint64_t counts[] = {
+                1, 4, 12, 56, 244, 1396, 8200, 55092, 390216
+        };
+        othello_t o;
+        uint64_t expected;
+        int depth, game, row, col, p, empties;
+
+        othello_init(&o);
+        for (depth = 0; depth < (int)(sizeof(counts) / sizeof(counts[0]));
+             depth++) {
+                if (othello_perft(&o, PLAYER_BLACK, depth, false) !=
+                    counts[depth] ||
+                    othello_perft(&o, PLAYER_BLACK, depth, true) !=
+                    counts[depth]) {
+                        fprintf(stderr, "wrong perft count at depth %d\n",
+                                depth);
+                        exit(EXIT_FAILURE);
+                }
+        }
+
+        srand(1);
+        for (game = 0; game < 20; game++) {
+                othello_init(&o);
+                p = PLAYER_BLACK;
+                empties = 60;
+
+                while (true) {
+                        if (!othello_has_valid_move(&o, (player_t)p)) {
+                                p ^= 1;
+                                if (!othello_has_valid_move(&o, (player_t)p)) {
+                                        break;
+                                }
+                        }
+                        if (empties % 10 == 4) {
+                                expected = reference_perft(&o, (player_t)p, 4);
+                                if (othello_perft(&o, (player_t)p, 4, false) !=
+                                    expected ||
+                                    othello_perft(&o, (player_t)p, 4, true) !=
+                                    expected) {
+                                        fprintf(stderr, "wrong perft count "
+                                                "in game %d\n", game);
+                                        exit(EXIT_FAILURE);
+                                }
+                        }
+                        othello_compute_random_move(&o, (player_t)p, &row,
+                                                    &col);
+                        othello_make_move(&o, (player_t)p, row, col);
+                        p ^= 1;
+                        empties--;
+                }
+        }
+}
+
 static void test_winning_move(void)
 {
         /* A basic test that we can compute a winning move. */
@@ -352,13 +506,1181 @@ static void test_winning_move(void)
 
         othello_compute_move(&o, PLAYER_WHITE, &row, &col);
 
-        if (row != 0 && col != 0) {
+        if (row != 0 || col != 0) {
+                fprintf(stderr, "expected A1 but got %c%d\n",
+                                "ABCDEFGH"[col], row + 1);
+                exit(EXIT_FAILURE);
+        }
+
+        othello_clear_hash();
+        othello_compute_move_mt(&o, PLAYER_WHITE, 4, &row, &col);
+
+        if (row != 0 || col != 0) {
+                fprintf(stderr, "expected A1 with 4 threads but got %c%d\n",
+                                "ABCDEFGH"[col], row + 1);
+                exit(EXIT_FAILURE);
+        }
+}
+
+static void test_parallel_midgame(void)
+{
+        /* A multi-threaded midgame search to a fixed depth, by either
+           method, plays a valid move with the score of a single-threaded
+           one. Without ProbCut, a fixed-depth search has one minimax value
+           whatever the threads leave in the table and in whatever order
+           they search. */
+
+        static const othello_probcut_t no_probcut[OTHELLO_PROBCUT_PHASES]
+                [OTHELLO_PROBCUT_MAX_DEPTH + 1];
+        static const othello_parallel_t methods[] = {
+                OTHELLO_PARALLEL_LAZY_SMP, OTHELLO_PARALLEL_YBWC
+        };
+        static const char *const names[] = { "Lazy SMP", "YBWC" };
+
+        othello_t o;
+        othello_search_info_t expected, info;
+        int move;
+        size_t i;
+
+        othello_from_string(midgame_board, &o);
+        othello_set_probcut(no_probcut);
+
+        othello_clear_hash();
+        othello_negamax_stats(&o, PLAYER_BLACK, 9, OTHELLO_SEARCH_ALL,
+                              &expected);
+        for (i = 0; i < sizeof(methods) / sizeof(methods[0]); i++) {
+                othello_clear_hash();
+                move = othello_iterative_negamax_mt(&o, PLAYER_BLACK, 9, 4,
+                                                    methods[i], &info);
+                if (!othello_is_valid_move(&o, PLAYER_BLACK, move / 8,
+                                           move % 8) ||
+                    info.score != expected.score) {
+                        fprintf(stderr, "%s scored %d for %c%d, expected "
+                                "%d\n", names[i], info.score,
+                                "ABCDEFGH"[move % 8], move / 8 + 1,
+                                expected.score);
+                        exit(EXIT_FAILURE);
+                }
+        }
+        othello_set_probcut(NULL);
+}
+
+static void test_timed_move(void)
+{
+        /* A timed search must return a valid move within its time, even if
+           the time is too short to finish an iteration, and find the
+           winning move in an endgame. */
+
+        static const int times[] = { 1, 50, 200 };
+
+        othello_t o;
+        othello_search_info_t stats;
+        clock_t start;
+        double elapsed;
+        int row, col;
+        size_t i;
+
+        const char endgame[] =
+        " abcdefgh \n"
+        "1.....x.o1\n"
+        "2oxxxx.oo2\n"
+        "3oxxxxooo3\n"
+        "4oxoxoxoo4\n"
+        "5ooxoxxoo5\n"
+        "6oooxoooo6\n"
+        "7ooooxoox7\n"
+        "8oxxxxxxx8\n"
+        " abcdefgh \n";
+
+        othello_from_string(midgame_board, &o);
+        for (i = 0; i < sizeof(times) / sizeof(times[0]); i++) {
+                othello_clear_hash();
+                start = clock();
+                othello_compute_move_timed(&o, PLAYER_BLACK, times[i],
+                                           OTHELLO_SEARCH_ALL, &row, &col,
+                                           &stats);
+                elapsed = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+                if (!othello_is_valid_move(&o, PLAYER_BLACK, row, col) ||
+                    stats.depth < 1) {
+                        fprintf(stderr, "no valid move in %d ms\n", times[i]);
+                        exit(EXIT_FAILURE);
+                }
+                if (elapsed > 2 * times[i] / 1000.0 + 0.1) {
+                        fprintf(stderr, "took %.3f s for %d ms\n", elapsed,
+                                times[i]);
+                        exit(EXIT_FAILURE);
+                }
+        }
+
+        othello_from_string(endgame, &o);
+        othello_compute_move_timed(&o, PLAYER_WHITE, 200, OTHELLO_SEARCH_ALL,
+                                   &row, &col, NULL);
+        if (row != 0 || col != 0) {
                 fprintf(stderr, "expected A1 but got %c%d\n",
                                 "ABCDEFGH"[col], row + 1);
                 exit(EXIT_FAILURE);
         }
 }
 
+static void test_move_budget(void)
+{
+        /* Searching a position again, with the deep results of the last
+           search in the table, stays within the move budget, though the
+           first iterations come almost free. */
+
+        othello_t o;
+        othello_search_info_t stats;
+        int row, col, i;
+
+        othello_from_string(midgame_board, &o);
+        othello_clear_hash();
+        for (i = 0; i < 3; i++) {
+                othello_compute_move_stats(&o, PLAYER_BLACK,
+                                           OTHELLO_SEARCH_ALL, &row, &col,
+                                           &stats);
+                if (stats.nodes > 10000000) {
+                        fprintf(stderr, "%llu nodes in search %d\n",
+                                (unsigned long long)stats.nodes, i + 1);
+                        exit(EXIT_FAILURE);
+                }
+        }
+}
+
+static void test_stopped_search(void)
+{
+        /* A search stopped before it starts still plays a valid move,
+           from a depth-1 search, in the midgame and in the endgame. */
+
+        static const int times[] = { 0, 10000 };
+
+        othello_stop_t stop = 1;
+        othello_t o;
+        othello_search_info_t stats;
+        int row, col, empties;
+        size_t i;
+        player_t p;
+
+        srand(1);
+        for (empties = 50; empties >= 10; empties -= 40) {
+                for (i = 0; i < sizeof(times) / sizeof(times[0]); i++) {
+                        /* Play random moves until there are that many
+                           empty cells and a move to make. */
+                        do {
+                                othello_init(&o);
+                                p = PLAYER_BLACK;
+                                while (othello_score(&o, p) +
+                                       othello_score(&o, p ^ 1) <
+                                       64 - empties) {
+                                        if (!othello_has_valid_move(&o, p)) {
+                                                p ^= 1;
+                                        }
+                                        if (!othello_has_valid_move(&o, p)) {
+                                                break;
+                                        }
+                                        othello_compute_random_move(&o, p,
+                                                                    &row,
+                                                                    &col);
+                                        othello_make_move(&o, p, row, col);
+                                        p ^= 1;
+                                }
+                        } while (!othello_has_valid_move(&o, p));
+
+                        othello_compute_move_stoppable(&o, p, times[i],
+                                                       OTHELLO_SEARCH_ALL &
+                                                       ~OTHELLO_SEARCH_BOOK,
+                                                       &stop, &row, &col,
+                                                       &stats);
+                        if (!othello_is_valid_move(&o, p, row, col) ||
+                            stats.depth != 1 || stats.exact ||
+                            stats.time > 1) {
+                                fprintf(stderr, "bad stopped search with "
+                                        "%d empty cells\n", empties);
+                                exit(EXIT_FAILURE);
+                        }
+                }
+        }
+}
+
+static void test_pondering(void)
+{
+        /* Pondering on the expected reply leaves results in the hash table
+           that make the search after it cheaper. */
+
+        othello_t o, after;
+        othello_search_info_t clean, pondered;
+        clock_t start;
+        int row, col;
+
+        othello_init(&o);
+        after = o;
+        othello_make_move(&after, PLAYER_BLACK, 2, 3);
+
+        othello_clear_hash();
+        othello_negamax_stats(&after, PLAYER_WHITE, 6, OTHELLO_SEARCH_ALL,
+                              &clean);
+
+        othello_clear_hash();
+        if (!othello_start_pondering(&o, PLAYER_BLACK, 2 * 8 + 3,
+                                     OTHELLO_SEARCH_ALL)) {
+                fprintf(stderr, "pondering did not start\n");
+                exit(EXIT_FAILURE);
+        }
+        start = clock();
+        while (clock() - start < CLOCKS_PER_SEC / 10) {
+        }
+        othello_stop_pondering();
+        othello_negamax_stats(&after, PLAYER_WHITE, 6, OTHELLO_SEARCH_ALL,
+                              &pondered);
+        if (pondered.nodes >= clean.nodes) {
+                fprintf(stderr, "%llu nodes after pondering, %llu without\n",
+                        (unsigned long long)pondered.nodes,
+                        (unsigned long long)clean.nodes);
+                exit(EXIT_FAILURE);
+        }
+
+        /* Stopping twice, or restarting, is harmless, and so is guessing
+           the reply. */
+        othello_stop_pondering();
+        othello_start_pondering(&o, PLAYER_BLACK, -1, OTHELLO_SEARCH_ALL);
+        othello_start_pondering(&o, PLAYER_BLACK, -1, OTHELLO_SEARCH_ALL);
+        othello_compute_move_stats(&after, PLAYER_WHITE, OTHELLO_SEARCH_ALL,
+                                   &row, &col, NULL);
+        othello_stop_pondering();
+        if (!othello_is_valid_move(&after, PLAYER_WHITE, row, col)) {
+                fprintf(stderr, "invalid move while pondering\n");
+                exit(EXIT_FAILURE);
+        }
+
+        /* Nothing to ponder on when the game is over. */
+        othello_set_cell_state(&o, 3, 3, CELL_BLACK);
+        othello_set_cell_state(&o, 4, 4, CELL_BLACK);
+        if (othello_start_pondering(&o, PLAYER_WHITE, -1,
+                                    OTHELLO_SEARCH_ALL)) {
+                fprintf(stderr, "pondering on a finished game\n");
+                exit(EXIT_FAILURE);
+        }
+}
+
+static void test_engine(void)
+{
+        /* An engine with the default settings searches like the functions
+           without one, engines with other settings find valid moves, and
+           invalid settings are refused. */
+
+        othello_engine_config_t config;
+        othello_engine_t *e, *small;
+        othello_search_info_t expected, info;
+        othello_t o;
+        int row, col, erow, ecol;
+
+        othello_init(&o);
+        othello_make_move(&o, PLAYER_BLACK, 2, 3);
+
+        othello_engine_default_config(&config);
+        e = othello_engine_create(&config);
+        othello_clear_hash();
+        othello_compute_move_stats(&o, PLAYER_WHITE, OTHELLO_SEARCH_ALL,
+                                   &erow, &ecol, &expected);
+        othello_engine_compute_move(e, &o, PLAYER_WHITE, 0, NULL, &row, &col,
+                                    &info);
+        if (row != erow || col != ecol || info.score != expected.score ||
+            info.nodes != expected.nodes) {
+                fprintf(stderr, "engine searched differently\n");
+                exit(EXIT_FAILURE);
+        }
+
+        config.hash_size = 1 << 16;
+        config.threads = 2;
+        config.huge_pages = true;
+        small = othello_engine_create(&config);
+        othello_engine_compute_move(small, &o, PLAYER_WHITE, 50, NULL, &row,
+                                    &col, &info);
+        if (!othello_is_valid_move(&o, PLAYER_WHITE, row, col)) {
+                fprintf(stderr, "invalid move with a small hash table\n");
+                exit(EXIT_FAILURE);
+        }
+
+        /* Both engines at once, one pondering. */
+        othello_engine_start_pondering(small, &o, PLAYER_WHITE, -1);
+        othello_engine_compute_move(e, &o, PLAYER_WHITE, 20, NULL, &row,
+                                    &col, &info);
+        othello_engine_destroy(small);
+        othello_engine_destroy(e);
+        if (!othello_is_valid_move(&o, PLAYER_WHITE, row, col)) {
+                fprintf(stderr, "invalid move while another engine "
+                        "pondered\n");
+                exit(EXIT_FAILURE);
+        }
+
+        config.book = "no such book";
+        if (othello_engine_create(&config) != NULL) {
+                fprintf(stderr, "engine created without its book\n");
+                exit(EXIT_FAILURE);
+        }
+        config.book = NULL;
+        config.evaluator = OTHELLO_EVAL_NETWORK;
+        if (othello_engine_create(&config) != NULL) {
+                fprintf(stderr, "engine created without its network\n");
+                exit(EXIT_FAILURE);
+        }
+}
+
+/* Built into othello.c with OTHELLO_TESTING. */
+uint64_t othello_hash_stress(int threads, int iterations);
+
+static void test_hash_stress(void)
+{
+        /* Threads overwriting each other's entries never return data stored
+           for another position. */
+
+        uint64_t corrupted = othello_hash_stress(4, 1000000);
+
+        if (corrupted != 0) {
+                fprintf(stderr, "%llu corrupted hash entries\n",
+                        (unsigned long long)corrupted);
+                exit(EXIT_FAILURE);
+        }
+}
+
+static void test_solve(void)
+{
+        /* Check the endgame solver against a full-width search. */
+
+        othello_t o;
+        int row, col, exact, wld, expected;
+
+        const char board[] =
+        " abcdefgh \n"
+        "1x..xxxxo1\n"
+        "2xoxxo.o.2\n"
+        "3xxoxxo.o3\n"
+        "4xxxox.o.4\n"
+        "5xxxoooo.5\n"
+        "6xxxoxo.o6\n"
+        "7ooxooxox7\n"
+        "8oooooox.8\n"
+        " abcdefgh \n";
+
+        othello_from_string(board, &o);
+
+        /* Search to the end of the game; terminal scores are scaled by
+           2^20. */
+        expected = othello_negamax(&o, PLAYER_BLACK, 64) / (1 << 20);
+        exact = othello_solve(&o, PLAYER_BLACK, OTHELLO_SOLVE_EXACT,
+                              &row, &col);
+        wld = othello_solve(&o, PLAYER_BLACK, OTHELLO_SOLVE_WLD, &row, &col);
+
+        if (exact != expected || (wld > 0) != (expected > 0) ||
+            (wld < 0) != (expected < 0)) {
+                fprintf(stderr, "expected %d but got %d (wld %d)\n",
+                                expected, exact, wld);
+                exit(EXIT_FAILURE);
+        }
+
+        othello_make_move(&o, PLAYER_BLACK, row, col);
+        if (-othello_negamax(&o, PLAYER_WHITE, 64) / (1 << 20) != expected) {
+                fprintf(stderr, "%c%d is not a perfect move\n",
+                                "ABCDEFGH"[col], row + 1);
+                exit(EXIT_FAILURE);
+        }
+}
+
+static void test_solve_mt(void)
+{
+        /* Parallel solvers must agree with the sequential one. */
+
+        static const othello_parallel_t methods[] = {
+                OTHELLO_PARALLEL_LAZY_SMP, OTHELLO_PARALLEL_YBWC
+        };
+
+        othello_t o;
+        othello_search_info_t stats;
+        int row, col, expected, score;
+        size_t i;
+
+        const char board[] =
+        " abcdefgh \n"
+        "1xoooo...1\n"
+        "2oxxoox..2\n"
+        "3xxxxoxo.3\n"
+        "4oxxoxoo.4\n"
+        "5xxoxxoo.5\n"
+        "6xxxxoxo.6\n"
+        "7..xxxo..7\n"
+        "8xoooo...8\n"
+        " abcdefgh \n";
+
+        othello_from_string(board, &o);
+        expected = othello_solve(&o, PLAYER_BLACK, OTHELLO_SOLVE_EXACT,
+                                 &row, &col);
+
+        for (i = 0; i < sizeof(methods) / sizeof(methods[0]); i++) {
+                othello_clear_hash();
+                score = othello_solve_mt(&o, PLAYER_BLACK,
+                                         OTHELLO_SOLVE_EXACT, 4, methods[i],
+                                         &row, &col, &stats);
+                if (score != expected) {
+                        fprintf(stderr, "expected %d but got %d (method %d)\n",
+                                        expected, score, (int)methods[i]);
+                        exit(EXIT_FAILURE);
+                }
+        }
+}
+
+static void check_stable(const char *board_str, player_t p,
+                         const char *expected_stable)
+{
+        othello_t o, m;
+        char s[1000];
+
+        othello_from_string(board_str, &o);
+
+        /* Put a black disk in each cell of m with a stable disk of p. */
+        m.disks[PLAYER_BLACK] = othello_stable_disks(&o, p);
+        m.disks[PLAYER_WHITE] = 0;
+
+        othello_to_string(&m, s);
+
+        if (strcmp(expected_stable, s) != 0) {
+                fprintf(stderr, "Error! Expected stable disks:\n%sbut got:\n%s",
+                                expected_stable, s);
+                exit(EXIT_FAILURE);
+        }
+}
+
+static void test_stable_disks(void)
+{
+        /* Stability spreads from the corner along the edge, and a full edge
+           is stable for both players. Then check in random games that
+           stable disks are never flipped. */
+
+        const char board[] =
+        " abcdefgh \n"
+        "1xxxo....1\n"
+        "2xo......2\n"
+        "3o.......3\n"
+        "4...ox...4\n"
+        "5...xo...5\n"
+        "6........6\n"
+        "7.x......7\n"
+        "8oxoxoxox8\n"
+        " abcdefgh \n";
+
+        const char black_stable[] =
+        " abcdefgh \n"
+        "1xxx.....1\n"
+        "2x.......2\n"
+        "3........3\n"
+        "4........4\n"
+        "5........5\n"
+        "6........6\n"
+        "7........7\n"
+        "8.x.x.x.x8\n"
+        " abcdefgh \n";
+
+        const char white_stable[] =
+        " abcdefgh \n"
+        "1........1\n"
+        "2........2\n"
+        "3........3\n"
+        "4........4\n"
+        "5........5\n"
+        "6........6\n"
+        "7........7\n"
+        "8x.x.x.x.8\n"
+        " abcdefgh \n";
+
+        othello_t o;
+        uint64_t stable[2];
+        int game, row, col, p;
+
+        check_stable(board, PLAYER_BLACK, black_stable);
+        check_stable(board, PLAYER_WHITE, white_stable);
+
+        srand(1);
+        for (game = 0; game < 200; game++) {
+                othello_init(&o);
+                stable[0] = stable[1] = 0;
+                p = PLAYER_BLACK;
+
+                while (true) {
+                        if (!othello_has_valid_move(&o, (player_t)p)) {
+                                p ^= 1;
+                                if (!othello_has_valid_move(&o, (player_t)p)) {
+                                        break;
+                                }
+                        }
+                        othello_compute_random_move(&o, (player_t)p, &row,
+                                                    &col);
+                        othello_make_move(&o, (player_t)p, row, col);
+                        p ^= 1;
+
+                        if ((o.disks[0] & stable[0]) != stable[0] ||
+                            (o.disks[1] & stable[1]) != stable[1]) {
+                                fprintf(stderr, "a stable disk was flipped "
+                                        "in game %d\n", game);
+                                exit(EXIT_FAILURE);
+                        }
+                        stable[0] |= othello_stable_disks(&o, PLAYER_BLACK);
+                        stable[1] |= othello_stable_disks(&o, PLAYER_WHITE);
+                }
+
+                if ((o.disks[0] | o.disks[1]) == ~0ULL &&
+                    (stable[0] != o.disks[0] || stable[1] != o.disks[1])) {
+                        fprintf(stderr, "full board not stable in game %d\n",
+                                game);
+                        exit(EXIT_FAILURE);
+                }
+        }
+}
+
+/* Check that info's principal variation starts with the move and can be
+   played from o. */
+static void check_pv(const othello_t *o, player_t p, int row, int col,
+                     const othello_search_info_t *info)
+{
+        othello_t b = *o;
+        int i, move;
+
+        if (info->pv_length < 1 || info->pv[0] != row * 8 + col) {
+                fprintf(stderr, "PV doesn't start with the move\n");
+                exit(EXIT_FAILURE);
+        }
+        for (i = 0; i < info->pv_length; i++) {
+                move = info->pv[i];
+                if (move == -1) {
+                        if (othello_has_valid_move(&b, p)) {
+                                fprintf(stderr, "pass in PV at %d\n", i);
+                                exit(EXIT_FAILURE);
+                        }
+                } else if (!othello_is_valid_move(&b, p, move / 8, move % 8)) {
+                        fprintf(stderr, "invalid move in PV at %d\n", i);
+                        exit(EXIT_FAILURE);
+                } else {
+                        othello_make_move(&b, p, move / 8, move % 8);
+                }
+                p ^= 1;
+        }
+}
+
+static void test_search_info(void)
+{
+        /* Check the search information of a midgame search and of a
+           solve. */
+
+        const char endgame[] =
+        " abcdefgh \n"
+        "1x..xxxxo1\n"
+        "2xoxxo.o.2\n"
+        "3xxoxxo.o3\n"
+        "4xxxox.o.4\n"
+        "5xxxoooo.5\n"
+        "6xxxoxo.o6\n"
+        "7ooxooxox7\n"
+        "8oooooox.8\n"
+        " abcdefgh \n";
+
+        othello_t o;
+        othello_search_info_t info;
+        uint64_t cutoffs = 0;
+        int row, col, i, score;
+
+        othello_from_string(midgame_board, &o);
+        othello_clear_hash();
+        othello_compute_move_stats(&o, PLAYER_BLACK, OTHELLO_SEARCH_ALL, &row,
+                                   &col, &info);
+        check_pv(&o, PLAYER_BLACK, row, col, &info);
+        for (i = 0; i < OTHELLO_MAX_PLY; i++) {
+                if (info.first_cutoffs[i] > info.cutoffs[i]) {
+                        fprintf(stderr, "more first move cutoffs than "
+                                "cutoffs at ply %d\n", i);
+                        exit(EXIT_FAILURE);
+                }
+                cutoffs += info.cutoffs[i];
+        }
+        if (info.exact || info.depth < 1 || info.seldepth < info.depth ||
+            info.pv_length < info.depth / 2 || cutoffs == 0 ||
+            info.evals == 0 || info.nodes < info.evals || info.time < 0) {
+                fprintf(stderr, "bad midgame search info\n");
+                exit(EXIT_FAILURE);
+        }
+
+        othello_from_string(endgame, &o);
+        score = othello_solve(&o, PLAYER_BLACK, OTHELLO_SOLVE_EXACT, &row,
+                              &col);
+        othello_clear_hash();
+        othello_compute_move_stats(&o, PLAYER_BLACK, OTHELLO_SEARCH_ALL, &row,
+                                   &col, &info);
+        check_pv(&o, PLAYER_BLACK, row, col, &info);
+        if (!info.exact || info.score != score ||
+            info.depth != 64 - othello_score(&o, PLAYER_BLACK) -
+                          othello_score(&o, PLAYER_WHITE)) {
+                fprintf(stderr, "bad endgame search info\n");
+                exit(EXIT_FAILURE);
+        }
+}
+
+static void test_probcut(void)
+{
+        /* With a huge deviation, nothing is ever cut off, so the score
+           must be the full-width one; with none, the search must be
+           smaller. */
+
+        static othello_probcut_t
+        table[OTHELLO_PROBCUT_PHASES][OTHELLO_PROBCUT_MAX_DEPTH + 1];
+        othello_search_info_t full, selective;
+        othello_t o;
+        int i, d, score;
+
+        othello_from_string(midgame_board, &o);
+        othello_clear_hash();
+        score = othello_negamax_stats(&o, PLAYER_BLACK, 7,
+                                      OTHELLO_SEARCH_ALL &
+                                      ~OTHELLO_SEARCH_PROBCUT, &full);
+
+        for (i = 0; i < OTHELLO_PROBCUT_PHASES; i++) {
+                for (d = 3; d <= OTHELLO_PROBCUT_MAX_DEPTH; d++) {
+                        table[i][d].depth = d / 2;
+                        table[i][d].a = 1;
+                        table[i][d].b = 0;
+                        table[i][d].sigma = 1e9f;
+                }
+        }
+        othello_set_probcut(table);
+        othello_clear_hash();
+        if (othello_negamax_stats(&o, PLAYER_BLACK, 7, OTHELLO_SEARCH_ALL,
+                                  &selective) != score) {
+                fprintf(stderr, "probcut changed the score\n");
+                exit(EXIT_FAILURE);
+        }
+
+        for (i = 0; i < OTHELLO_PROBCUT_PHASES; i++) {
+                for (d = 3; d <= OTHELLO_PROBCUT_MAX_DEPTH; d++) {
+                        table[i][d].sigma = 0;
+                }
+        }
+        othello_set_probcut(table);
+        othello_clear_hash();
+        othello_negamax_stats(&o, PLAYER_BLACK, 7, OTHELLO_SEARCH_ALL,
+                              &selective);
+        othello_set_probcut(NULL);
+        if (selective.nodes >= full.nodes || selective.pv_length < 1 ||
+            !othello_is_valid_move(&o, PLAYER_BLACK, selective.pv[0] / 8,
+                                   selective.pv[0] % 8)) {
+                fprintf(stderr, "probcut searched %llu nodes, not fewer "
+                        "than %llu\n", (unsigned long long)selective.nodes,
+                        (unsigned long long)full.nodes);
+                exit(EXIT_FAILURE);
+        }
+}
+
+/* Cell (row, col) after symmetry t: a reflection in the a1-h8 diagonal if
+   bit 2 is set, then a left-right mirror if bit 0 is, then an upside-down
+   flip if bit 1 is. */
+static int transform_cell(int row, int col, int t)
+{
+        int tmp;
+
+        if (t & 4) {
+                tmp = row;
+                row = col;
+                col = tmp;
+        }
+        if (t & 1) {
+                col = 7 - col;
+        }
+        if (t & 2) {
+                row = 7 - row;
+        }
+
+        return row * 8 + col;
+}
+
+static void transform_board(const othello_t *o, int t, othello_t *out)
+{
+        int row, col, idx;
+
+        memset(out, 0, sizeof(*out));
+        for (row = 0; row < 8; row++) {
+                for (col = 0; col < 8; col++) {
+                        idx = transform_cell(row, col, t);
+                        othello_set_cell_state(out, idx / 8, idx % 8,
+                                               othello_cell_state(o, row,
+                                                                  col));
+                }
+        }
+}
+
+static bool less_than(const othello_t *a, const othello_t *b)
+{
+        return a->disks[0] < b->disks[0] ||
+               (a->disks[0] == b->disks[0] && a->disks[1] < b->disks[1]);
+}
+
+static void test_symmetries(void)
+{
+        /* Compare the transformations with moving cells one at a time,
+           and check that moves and canonical forms are preserved, in
+           positions from random games. */
+
+        othello_t o, t_o, expected, canonical, c;
+        int game, t, u, i, row, col, idx, p;
+
+        for (t = 0; t < OTHELLO_NUM_TRANSFORMS; t++) {
+                u = othello_inverse_transform(t);
+                for (i = 0; i < 64; i++) {
+                        idx = transform_cell(i / 8, i % 8, t);
+                        if (othello_transform_cells(1ULL << i, t) !=
+                            1ULL << idx ||
+                            othello_transform_cells(1ULL << idx, u) !=
+                            1ULL << i) {
+                                fprintf(stderr, "bad transformation %d of "
+                                        "cell %d\n", t, i);
+                                exit(EXIT_FAILURE);
+                        }
+                }
+        }
+
+        srand(1);
+        for (game = 0; game < 50; game++) {
+                othello_init(&o);
+                p = PLAYER_BLACK;
+
+                while (true) {
+                        if (!othello_has_valid_move(&o, (player_t)p)) {
+                                p ^= 1;
+                                if (!othello_has_valid_move(&o, (player_t)p)) {
+                                        break;
+                                }
+                        }
+
+                        t = othello_canonical(&o, &canonical);
+                        othello_transform(&o, t, &c);
+                        if (memcmp(&c, &canonical, sizeof(c)) != 0) {
+                                fprintf(stderr, "canonical form is not "
+                                        "transformation %d\n", t);
+                                exit(EXIT_FAILURE);
+                        }
+
+                        for (u = 0; u < OTHELLO_NUM_TRANSFORMS; u++) {
+                                othello_transform(&o, u, &t_o);
+                                transform_board(&o, u, &expected);
+                                if (memcmp(&t_o, &expected, sizeof(t_o))) {
+                                        fprintf(stderr, "bad transformation "
+                                                "%d in game %d\n", u, game);
+                                        exit(EXIT_FAILURE);
+                                }
+                                if (less_than(&t_o, &canonical) ||
+                                    (u < t && !less_than(&canonical, &t_o))) {
+                                        fprintf(stderr, "transformation %d "
+                                                "is smaller than the "
+                                                "canonical form\n", u);
+                                        exit(EXIT_FAILURE);
+                                }
+                                othello_canonical(&t_o, &c);
+                                if (memcmp(&c, &canonical, sizeof(c)) != 0) {
+                                        fprintf(stderr, "canonical forms "
+                                                "differ\n");
+                                        exit(EXIT_FAILURE);
+                                }
+
+                                for (i = 0; i < 64; i++) {
+                                        idx = transform_cell(i / 8, i % 8, u);
+                                        if (othello_is_valid_move(&o,
+                                                (player_t)p, i / 8, i % 8) !=
+                                            othello_is_valid_move(&t_o,
+                                                (player_t)p, idx / 8,
+                                                idx % 8)) {
+                                                fprintf(stderr, "moves "
+                                                        "differ after "
+                                                        "transformation "
+                                                        "%d\n", u);
+                                                exit(EXIT_FAILURE);
+                                        }
+                                }
+                        }
+
+                        othello_compute_random_move(&o, (player_t)p, &row,
+                                                    &col);
+                        othello_make_move(&o, (player_t)p, row, col);
+                        p ^= 1;
+                }
+        }
+}
+
+static void test_opening_book(void)
+{
+        /* A position added to the book must be found in all its rotations
+           and reflections, with the moves transformed to match, and must
+           survive saving and loading. */
+
+        static const char path[] = "othello_test_book.bin";
+        static const char bad_path[] = "othello_test_bad_book.bin";
+        static const char bad_dir_path[] = "othello_test_no_dir/book.bin";
+        static const char truncated[40] = "OTHEBOOK";
+
+        othello_book_moves_t moves, found;
+        othello_search_info_t info;
+        othello_t o, t_o;
+        int t, i, row, col;
+        FILE *f;
+
+        othello_from_string(midgame_board, &o);
+        moves.n_moves = 2;
+        moves.moves[0] = 2 * 8 + 0;     /* a3 */
+        moves.scores[0] = 12;
+        moves.moves[1] = 5 * 8 + 6;     /* g6 */
+        moves.scores[1] = -3;
+        moves.depth = 10;
+        if (!othello_is_valid_move(&o, PLAYER_WHITE, 2, 0) ||
+            !othello_is_valid_move(&o, PLAYER_WHITE, 5, 6) ||
+            othello_book_lookup(&o, PLAYER_WHITE, &found) ||
+            !othello_book_add(&o, PLAYER_WHITE, &moves)) {
+                fprintf(stderr, "cannot add book position\n");
+                exit(EXIT_FAILURE);
+        }
+
+        for (i = 0; i < 2; i++) {
+                for (t = 0; t < 8; t++) {
+                        transform_board(&o, t, &t_o);
+                        if (!othello_book_lookup(&t_o, PLAYER_WHITE, &found) ||
+                            found.n_moves != 2 || found.depth != 10 ||
+                            found.moves[0] != transform_cell(2, 0, t) ||
+                            found.moves[1] != transform_cell(5, 6, t) ||
+                            found.scores[0] != 12 || found.scores[1] != -3) {
+                                fprintf(stderr, "bad book entry for "
+                                        "symmetry %d\n", t);
+                                exit(EXIT_FAILURE);
+                        }
+                        if (othello_book_lookup(&t_o, PLAYER_BLACK, &found)) {
+                                fprintf(stderr, "book entry for the wrong "
+                                        "side\n");
+                                exit(EXIT_FAILURE);
+                        }
+                }
+
+                if (i == 0) {
+                        /* A failed save must keep the book. */
+                        if (othello_save_book(bad_dir_path) ||
+                            !othello_book_lookup(&o, PLAYER_WHITE, &found)) {
+                                fprintf(stderr, "failed save lost the "
+                                        "book\n");
+                                exit(EXIT_FAILURE);
+                        }
+                        if (!othello_save_book(path) ||
+                            othello_book_lookup(&o, PLAYER_WHITE, &found) ||
+                            !othello_load_book(path)) {
+                                fprintf(stderr, "cannot save and load the "
+                                        "book\n");
+                                exit(EXIT_FAILURE);
+                        }
+                }
+        }
+
+        othello_compute_move_stats(&o, PLAYER_WHITE, OTHELLO_SEARCH_ALL, &row,
+                                   &col, &info);
+        if (row != 2 || col != 0 || info.score != 12 || info.depth != 10 ||
+            info.nodes != 0) {
+                fprintf(stderr, "book move was not played\n");
+                exit(EXIT_FAILURE);
+        }
+
+        /* A truncated file must be rejected, keeping the loaded book. */
+        f = fopen(bad_path, "wb");
+        if (f == NULL || fwrite(truncated, sizeof(truncated), 1, f) != 1 ||
+            fclose(f) != 0 || othello_load_book(bad_path) ||
+            !othello_book_lookup(&o, PLAYER_WHITE, &found)) {
+                fprintf(stderr, "truncated book file was not rejected\n");
+                exit(EXIT_FAILURE);
+        }
+
+        othello_unload_book();
+        remove(path);
+        remove(bad_path);
+        if (othello_book_lookup(&o, PLAYER_WHITE, &found)) {
+                fprintf(stderr, "book was not unloaded\n");
+                exit(EXIT_FAILURE);
+        }
+}
+
+/* Write a weight file whose weights are zero except for weights[idx] = w, or
+   random if seed is non-zero. */
+static bool write_weights(const char *path, size_t idx, int16_t w,
+                          uint64_t seed)
+{
+        int16_t *weights;
+        size_t i;
+        bool ok;
+
+        weights = calloc(OTHELLO_NUM_WEIGHTS, sizeof(*weights));
+        if (weights == NULL) {
+                return false;
+        }
+        if (idx < OTHELLO_NUM_WEIGHTS) {
+                weights[idx] = w;
+        }
+        for (i = 0; seed != 0 && i < OTHELLO_NUM_WEIGHTS; i++) {
+                weights[i] = (int16_t)(xorshift64(&seed) % 201) - 100;
+        }
+        ok = othello_save_weights(path, weights);
+        free(weights);
+
+        return ok;
+}
+
+static void test_pattern_eval(void)
+{
+        /* The weights of the 4-square diagonals start at 167184; all four
+           are empty at the start of the game. */
+
+        static const char path[] = "othello_test_weights.bin";
+        static const char bad_path[] = "othello_test_bad_weights.bin";
+        static const char truncated[64] = "OTHWGHTS";
+        othello_t o;
+        int builtin, score;
+        FILE *f;
+
+        othello_init(&o);
+        builtin = othello_eval(&o, PLAYER_BLACK);
+
+        if (!write_weights(path, 167184, 5, 0)) {
+                fprintf(stderr, "cannot write %s\n", path);
+                exit(EXIT_FAILURE);
+        }
+        if (!othello_load_weights(path)) {
+                fprintf(stderr, "cannot load %s\n", path);
+                exit(EXIT_FAILURE);
+        }
+        score = othello_eval(&o, PLAYER_BLACK);
+        if (score != 4 * 5) {
+                fprintf(stderr, "expected %d but got %d\n", 4 * 5, score);
+                exit(EXIT_FAILURE);
+        }
+
+        /* A truncated file must be rejected without affecting the loaded
+           weights. (The mapped file itself must not be modified.) */
+        f = fopen(bad_path, "wb");
+        if (f == NULL || fwrite(truncated, sizeof(truncated), 1, f) != 1 ||
+            fclose(f) != 0 || othello_load_weights(bad_path) ||
+            othello_eval(&o, PLAYER_BLACK) != score) {
+                fprintf(stderr, "truncated weight file was not rejected\n");
+                exit(EXIT_FAILURE);
+        }
+
+        othello_unload_weights();
+        remove(path);
+        remove(bad_path);
+        if (othello_eval(&o, PLAYER_BLACK) != builtin) {
+                fprintf(stderr, "built-in evaluation was not restored\n");
+                exit(EXIT_FAILURE);
+        }
+}
+
+static void test_pattern_features(void)
+{
+        /* The evaluation is the sum of the weights of the features. */
+
+        static const char path[] = "othello_test_weights.bin";
+        int16_t *weights;
+        int features[OTHELLO_NUM_PATTERNS];
+        uint64_t seed = 42;
+        othello_t o;
+        player_t p;
+        int i, j, n, row, col, sum;
+
+        weights = calloc(OTHELLO_NUM_WEIGHTS, sizeof(*weights));
+        for (i = 0; weights != NULL && i < OTHELLO_NUM_WEIGHTS; i++) {
+                weights[i] = (int16_t)(xorshift64(&seed) % 201) - 100;
+        }
+        if (weights == NULL || !othello_save_weights(path, weights) ||
+            !othello_load_weights(path)) {
+                fprintf(stderr, "cannot write and load %s\n", path);
+                exit(EXIT_FAILURE);
+        }
+
+        othello_init(&o);
+        p = PLAYER_BLACK;
+        for (i = 0; i < 50 && othello_has_valid_move(&o, p); i++) {
+                n = othello_pattern_features(&o, p, features);
+                sum = 0;
+                for (j = 0; j < n; j++) {
+                        sum += weights[features[j]];
+                }
+                if (sum != othello_eval(&o, p)) {
+                        fprintf(stderr, "move %d: expected %d but got %d\n",
+                                        i, othello_eval(&o, p), sum);
+                        exit(EXIT_FAILURE);
+                }
+
+                othello_compute_random_move(&o, p, &row, &col);
+                othello_make_move(&o, p, row, col);
+                if (othello_has_valid_move(&o, p ^ 1)) {
+                        p ^= 1;
+                }
+        }
+
+        othello_unload_weights();
+        remove(path);
+        free(weights);
+}
+
+static void test_incremental_eval(void)
+{
+        /* Searching with incrementally updated pattern codes must give the
+           same results as computing them at each leaf. */
+
+        static const char path[] = "othello_test_weights.bin";
+        othello_t o;
+        player_t p;
+        int i, row, col, full, incremental;
+
+        if (!write_weights(path, 0, 0, 12345) ||
+            !othello_load_weights(path)) {
+                fprintf(stderr, "cannot write and load %s\n", path);
+                exit(EXIT_FAILURE);
+        }
+
+        othello_init(&o);
+        p = PLAYER_BLACK;
+        for (i = 0; i < 30 && othello_has_valid_move(&o, p); i++) {
+                othello_clear_hash();
+                full = othello_negamax_stats(&o, p, 4, OTHELLO_SEARCH_ALL &
+                                             ~OTHELLO_SEARCH_INCREMENTAL,
+                                             NULL);
+                othello_clear_hash();
+                incremental = othello_negamax_stats(&o, p, 4,
+                                                    OTHELLO_SEARCH_ALL, NULL);
+                if (full != incremental) {
+                        fprintf(stderr, "move %d: expected %d but got %d\n",
+                                        i, full, incremental);
+                        exit(EXIT_FAILURE);
+                }
+
+                othello_compute_random_move(&o, p, &row, &col);
+                othello_make_move(&o, p, row, col);
+                if (othello_has_valid_move(&o, p ^ 1)) {
+                        p ^= 1;
+                }
+        }
+
+        /* Also with threads, which start from their own positions. */
+        othello_iterative_negamax_mt(&o, p, 6, 4, OTHELLO_PARALLEL_LAZY_SMP,
+                                     NULL);
+        othello_iterative_negamax_mt(&o, p, 6, 4, OTHELLO_PARALLEL_YBWC, NULL);
+
+        othello_unload_weights();
+        remove(path);
+}
+
+static int random_weight(uint64_t *state, int range)
+{
+        return (int)(xorshift64(state) % (uint64_t)(2 * range + 1)) - range;
+}
+
+static void test_network_eval(void)
+{
+        /* All implementations must agree, and incrementally updated
+           accumulators must give the same search results. */
+
+        static const othello_simd_t impls[] = {
+                OTHELLO_SIMD_SCALAR, OTHELLO_SIMD_SSE2, OTHELLO_SIMD_AVX2
+        };
+        static const char path[] = "othello_test_network.bin";
+        othello_network_t *net;
+        uint64_t seed = 7;
+        othello_t o;
+        player_t p;
+        int i, j, row, col, score, expected, full, incremental;
+
+        net = calloc(1, sizeof(*net));
+        if (net == NULL) {
+                exit(EXIT_FAILURE);
+        }
+        for (i = 0; i < OTHELLO_NET_INPUTS; i++) {
+                for (j = 0; j < OTHELLO_NET_HIDDEN1; j++) {
+                        net->w1[i][j] = (int16_t)random_weight(&seed, 16);
+                }
+        }
+        for (j = 0; j < OTHELLO_NET_HIDDEN1; j++) {
+                net->b1[j] = (int16_t)(32 + random_weight(&seed, 32));
+        }
+        for (i = 0; i < OTHELLO_NET_HIDDEN2; i++) {
+                for (j = 0; j < OTHELLO_NET_HIDDEN1; j++) {
+                        net->w2[i][j] = (int16_t)random_weight(&seed, 32);
+                }
+                net->b2[i] = random_weight(&seed, 4096);
+                net->w3[i] = (int16_t)random_weight(&seed, 256);
+        }
+        net->b3 = random_weight(&seed, 1000);
+
+        othello_init(&o);
+        if (othello_network_eval(&o, PLAYER_BLACK, OTHELLO_SIMD_DEFAULT,
+                                 &score) ||
+            othello_set_evaluator(OTHELLO_EVAL_NETWORK)) {
+                fprintf(stderr, "network used before loading\n");
+                exit(EXIT_FAILURE);
+        }
+        if (!othello_save_network(path, net) || !othello_load_network(path)) {
+                fprintf(stderr, "cannot write and load %s\n", path);
+                exit(EXIT_FAILURE);
+        }
+
+        p = PLAYER_BLACK;
+        for (i = 0; i < 40 && othello_has_valid_move(&o, p); i++) {
+                expected = othello_eval(&o, p);
+                for (j = 0; j < (int)(sizeof(impls) / sizeof(impls[0]));
+                     j++) {
+                        if (othello_network_eval(&o, p, impls[j], &score) &&
+                            score != expected) {
+                                fprintf(stderr, "impl %d: expected %d but "
+                                                "got %d\n", (int)impls[j],
+                                                expected, score);
+                                exit(EXIT_FAILURE);
+                        }
+                }
+
+                othello_clear_hash();
+                full = othello_negamax_stats(&o, p, 4, OTHELLO_SEARCH_ALL &
+                                             ~OTHELLO_SEARCH_INCREMENTAL,
+                                             NULL);
+                othello_clear_hash();
+                incremental = othello_negamax_stats(&o, p, 4,
+                                                    OTHELLO_SEARCH_ALL, NULL);
+                if (full != incremental) {
+                        fprintf(stderr, "move %d: expected %d but got %d\n",
+                                        i, full, incremental);
+                        exit(EXIT_FAILURE);
+                }
+
+                othello_compute_random_move(&o, p, &row, &col);
+                othello_make_move(&o, p, row, col);
+                if (othello_has_valid_move(&o, p ^ 1)) {
+                        p ^= 1;
+                }
+        }
+
+        /* Switching evaluators, and unloading the one in use. */
+        othello_network_eval(&o, p, OTHELLO_SIMD_DEFAULT, &score);
+        if (!othello_set_evaluator(OTHELLO_EVAL_BUILTIN)) {
+                exit(EXIT_FAILURE);
+        }
+        expected = othello_eval(&o, p);
+        if (!othello_set_evaluator(OTHELLO_EVAL_NETWORK) ||
+            othello_eval(&o, p) != score) {
+                fprintf(stderr, "cannot switch evaluators\n");
+                exit(EXIT_FAILURE);
+        }
+
+        othello_unload_network();
+        remove(path);
+        free(net);
+        if (othello_eval(&o, p) != expected) {
+                fprintf(stderr, "built-in evaluation was not restored\n");
+                exit(EXIT_FAILURE);
+        }
+}
+
 static const struct {
         const char *name;
         void (*f)(void);
@@ -368,11 +1690,31 @@ static const struct {
         { "gen_moves_all_dirs",  test_gen_moves_all_dirs },
         { "gen_moves_no_wrap_l", test_gen_moves_no_wrap_l },
         { "gen_moves_no_wrap_r", test_gen_moves_no_wrap_r },
+        { "gen_moves_impls",     test_gen_moves_impls },
         { "resolve_7_steps",     test_resolve_7_steps },
         { "resolve_all_dirs",    test_resolve_all_dirs },
         { "resolve_no_wrap_l",   test_resolve_no_wrap_l },
         { "resolve_no_wrap_r",   test_resolve_no_wrap_r },
-        { "winning_move",        test_winning_move }
+        { "perft",               test_perft },
+        { "winning_move",        test_winning_move },
+        { "parallel_midgame",    test_parallel_midgame },
+        { "timed_move",          test_timed_move },
+        { "move_budget",         test_move_budget },
+        { "stopped_search",      test_stopped_search },
+        { "pondering",           test_pondering },
+        { "engine",              test_engine },
+        { "hash_stress",         test_hash_stress },
+        { "solve",               test_solve },
+        { "solve_mt",            test_solve_mt },
+        { "search_info",         test_search_info },
+        { "probcut",             test_probcut },
+        { "symmetries",          test_symmetries },
+        { "opening_book",        test_opening_book },
+        { "stable_disks",        test_stable_disks },
+        { "pattern_eval",        test_pattern_eval },
+        { "pattern_features",    test_pattern_features },
+        { "incremental_eval",    test_incremental_eval },
+        { "network_eval",        test_network_eval }
 };
 
 int main()
@@ -0,0 +1,869 @@
+/* Train evaluation weights from self-play games.
+
+   othello_train generate [-n games] [-r random moves] [-e solve empties]
+                          [-b eval budget] [-w weights] [-s seed] positions
+   othello_train fit [-j threads] [-i iterations] [-l rate] positions weights
+   othello_train fit-network [-i iterations] [-l rate] positions network
+   othello_train probcut [-n samples] [-d depth] [-w weights] [-m network]
+                         positions
+
+   generate plays games against itself and appends the positions to a file,
+   each labelled with the final disk difference for the side to move: the
+   first moves are random, then othello_iterative_negamax() plays until few
+   enough cells are empty to solve the rest of the game exactly.
+
+   fit reads the positions in chunks, so the file can be much larger than
+   memory, and fits the weights by least squares with gradient descent,
+   splitting each pass over the file between threads. fit-network trains
+   the neural network evaluation in the same way, but one position at a
+   time.
+
+   probcut searches positions spread evenly through the file to each depth
+   and fits the Multi-ProbCut parameters for the evaluation, printing them
+   as a C table for othello_set_probcut(). */
+
+#include <errno.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "othello.h"
+
+/* Evaluation units per disk. */
+#define DISK_SCALE 16
+
+/* A position record: the disks of the side to move and of the opponent, as
+   little-endian 64-bit numbers, and the final disk difference. */
+#define RECORD_SIZE 17
+
+typedef struct {
+        othello_t o;            /* PLAYER_BLACK is the side to move. */
+        int score;
+} position_t;
+
+static void encode_position(const position_t *pos, unsigned char *buf)
+{
+        int i;
+
+        for (i = 0; i < 8; i++) {
+                buf[i] = (unsigned char)(pos->o.disks[0] >> (i * 8));
+                buf[i + 8] = (unsigned char)(pos->o.disks[1] >> (i * 8));
+        }
+        buf[16] = (unsigned char)(int8_t)pos->score;
+}
+
+static void decode_position(const unsigned char *buf, position_t *pos)
+{
+        int i;
+
+        pos->o.disks[0] = 0;
+        pos->o.disks[1] = 0;
+        for (i = 0; i < 8; i++) {
+                pos->o.disks[0] |= (uint64_t)buf[i] << (i * 8);
+                pos->o.disks[1] |= (uint64_t)buf[i + 8] << (i * 8);
+        }
+        pos->score = (int8_t)buf[16];
+}
+
+static void usage(void)
+{
+        fprintf(stderr,
+                "usage: othello_train generate [-n games] [-r random moves] "
+                "[-e solve empties]\n"
+                "                              [-b eval budget] [-w weights] "
+                "[-s seed] positions\n"
+                "       othello_train fit [-j threads] [-i iterations] "
+                "[-l rate] positions weights\n"
+                "       othello_train fit-network [-i iterations] [-l rate] "
+                "positions network\n"
+                "       othello_train probcut [-n samples] [-d depth] "
+                "[-w weights] [-m network]\n"
+                "                             positions\n");
+        exit(1);
+}
+
+static int parse_int(const char *s, int min)
+{
+        char *end;
+        long x;
+
+        errno = 0;
+        x = strtol(s, &end, 10);
+        if (errno || *end || x < min || x > 1000000000) {
+                usage();
+        }
+
+        return (int)x;
+}
+
+static void write_position(FILE *f, const othello_t *o, player_t p,
+                           int score)
+{
+        unsigned char buf[RECORD_SIZE];
+        position_t pos;
+
+        pos.o.disks[0] = o->disks[p];
+        pos.o.disks[1] = o->disks[p ^ 1];
+        pos.score = score;
+        encode_position(&pos, buf);
+
+        if (fwrite(buf, sizeof(buf), 1, f) != 1) {
+                perror("fwrite");
+                exit(1);
+        }
+}
+
+static int empty_cells(const othello_t *o)
+{
+        return 64 - othello_score(o, PLAYER_BLACK) -
+               othello_score(o, PLAYER_WHITE);
+}
+
+/* Play the rest of the game perfectly, writing each position with its
+   exact score. Returns the final disk difference for black. */
+static int solve_rest(FILE *f, othello_t *o, player_t p, int *written)
+{
+        int row, col, score, final_score = 0;
+        bool first = true;
+
+        while (true) {
+                if (!othello_has_valid_move(o, p)) {
+                        p ^= 1;
+                        if (!othello_has_valid_move(o, p)) {
+                                break;
+                        }
+                }
+
+                score = othello_solve(o, p, OTHELLO_SOLVE_EXACT, &row, &col);
+                if (first) {
+                        final_score = p == PLAYER_BLACK ? score : -score;
+                        first = false;
+                }
+                write_position(f, o, p, score);
+                (*written)++;
+
+                othello_make_move(o, p, row, col);
+                p ^= 1;
+        }
+
+        if (first) {
+                /* The game was already over. */
+                final_score = othello_score(o, PLAYER_BLACK) -
+                              othello_score(o, PLAYER_WHITE);
+        }
+
+        return final_score;
+}
+
+/* Play a game and write its positions. Returns the number written. */
+static int play_game(FILE *f, int random_moves, int solve_empties,
+                     int budget)
+{
+        othello_t history[64], o;
+        player_t sides[64], p;
+        int i, n, written, row, col, move, final_score;
+
+        othello_init(&o);
+        p = PLAYER_BLACK;
+        n = 0;
+        written = 0;
+
+        while (empty_cells(&o) > solve_empties) {
+                if (!othello_has_valid_move(&o, p)) {
+                        p ^= 1;
+                        if (!othello_has_valid_move(&o, p)) {
+                                break;
+                        }
+                }
+
+                history[n] = o;
+                sides[n] = p;
+                n++;
+
+                if (n <= random_moves) {
+                        othello_compute_random_move(&o, p, &row, &col);
+                } else {
+                        move = othello_iterative_negamax(&o, p, budget);
+                        row = move / 8;
+                        col = move % 8;
+                }
+                othello_make_move(&o, p, row, col);
+                p ^= 1;
+        }
+
+        final_score = solve_rest(f, &o, p, &written);
+
+        for (i = 0; i < n; i++) {
+                write_position(f, &history[i], sides[i],
+                               sides[i] == PLAYER_BLACK ? final_score :
+                                                          -final_score);
+        }
+
+        return written + n;
+}
+
+static int generate(int argc, char **argv)
+{
+        int games = 1000, random_moves = 10, solve_empties = 14;
+        int budget = 2000;
+        unsigned seed = 1;
+        long positions = 0;
+        FILE *f;
+        int c, i;
+
+        while ((c = getopt(argc, argv, "n:r:e:b:w:s:")) != -1) {
+                switch (c) {
+                case 'n': games = parse_int(optarg, 1); break;
+                case 'r': random_moves = parse_int(optarg, 0); break;
+                case 'e': solve_empties = parse_int(optarg, 0); break;
+                case 'b': budget = parse_int(optarg, 1); break;
+                case 's': seed = (unsigned)parse_int(optarg, 0); break;
+                case 'w':
+                        if (!othello_load_weights(optarg)) {
+                                fprintf(stderr, "invalid weight file: %s\n",
+                                        optarg);
+                                return 1;
+                        }
+                        break;
+                default: usage();
+                }
+        }
+        if (optind != argc - 1) {
+                usage();
+        }
+
+        /* Append, so that several runs can add to the same file. */
+        f = fopen(argv[optind], "ab");
+        if (f == NULL) {
+                perror(argv[optind]);
+                return 1;
+        }
+
+        srand(seed);
+        for (i = 0; i < games; i++) {
+                positions += play_game(f, random_moves, solve_empties, budget);
+                if ((i + 1) % 100 == 0 || i + 1 == games) {
+                        printf("%d games, %ld positions\n", i + 1, positions);
+                        fflush(stdout);
+                }
+        }
+
+        if (fclose(f) != 0) {
+                perror("fclose");
+                return 1;
+        }
+
+        return 0;
+}
+
+/* Fitting. Each iteration, the threads read their part of the file and sum
+   the residuals of the positions each weight takes part in; then every
+   weight moves towards the mean residual of its positions. */
+
+#define MAX_THREADS 64
+#define CHUNK_RECORDS 4096
+#define SMOOTHING 4             /* Damps weights seen in few positions. */
+
+typedef struct {
+        const char *path;
+        long first, end;        /* Range of records. */
+        const float *weights;
+        float *residuals;       /* Per weight. */
+        uint32_t *counts;       /* Per weight, or NULL after the first pass. */
+        double squared_error;
+        pthread_t thread;
+} fit_thread_t;
+
+static void *fit_thread(void *arg)
+{
+        fit_thread_t *t = arg;
+        unsigned char *buf;
+        int features[OTHELLO_NUM_PATTERNS];
+        position_t pos;
+        long i, j, n;
+        float r;
+        int k, m;
+        FILE *f;
+
+        buf = malloc((size_t)CHUNK_RECORDS * RECORD_SIZE);
+        f = fopen(t->path, "rb");
+        if (buf == NULL || f == NULL ||
+            fseek(f, t->first * RECORD_SIZE, SEEK_SET) != 0) {
+                perror(t->path);
+                exit(1);
+        }
+
+        memset(t->residuals, 0, OTHELLO_NUM_WEIGHTS * sizeof(float));
+        t->squared_error = 0;
+
+        for (i = t->first; i < t->end; i += n) {
+                n = t->end - i < CHUNK_RECORDS ? t->end - i : CHUNK_RECORDS;
+                if (fread(buf, RECORD_SIZE, (size_t)n, f) != (size_t)n) {
+                        fprintf(stderr, "%s: read error\n", t->path);
+                        exit(1);
+                }
+
+                for (j = 0; j < n; j++) {
+                        decode_position(&buf[j * RECORD_SIZE], &pos);
+                        m = othello_pattern_features(&pos.o, PLAYER_BLACK,
+                                                     features);
+                        r = (float)(pos.score * DISK_SCALE);
+                        for (k = 0; k < m; k++) {
+                                r -= t->weights[features[k]];
+                        }
+                        for (k = 0; k < m; k++) {
+                                t->residuals[features[k]] += r;
+                        }
+                        if (t->counts != NULL) {
+                                for (k = 0; k < m; k++) {
+                                        t->counts[features[k]]++;
+                                }
+                        }
+                        t->squared_error += (double)r * r;
+                }
+        }
+
+        fclose(f);
+        free(buf);
+
+        return NULL;
+}
+
+static int fit(int argc, char **argv)
+{
+        fit_thread_t threads[MAX_THREADS];
+        int n_threads = 4, iterations = 100;
+        double rate = 1.0 / OTHELLO_NUM_PATTERNS;
+        float *weights = NULL, *residuals = NULL;
+        uint32_t *counts = NULL;
+        int16_t *quantized = NULL;
+        long records, i;
+        double error;
+        FILE *f;
+        int c, t, it;
+
+        while ((c = getopt(argc, argv, "j:i:l:")) != -1) {
+                switch (c) {
+                case 'j': n_threads = parse_int(optarg, 1); break;
+                case 'i': iterations = parse_int(optarg, 1); break;
+                case 'l': rate = atof(optarg); break;
+                default: usage();
+                }
+        }
+        if (optind != argc - 2 || rate <= 0) {
+                usage();
+        }
+        n_threads = n_threads > MAX_THREADS ? MAX_THREADS : n_threads;
+
+        f = fopen(argv[optind], "rb");
+        if (f == NULL || fseek(f, 0, SEEK_END) != 0 ||
+            (records = ftell(f) / RECORD_SIZE) <= 0) {
+                fprintf(stderr, "%s: no positions\n", argv[optind]);
+                return 1;
+        }
+        fclose(f);
+
+        weights = calloc(OTHELLO_NUM_WEIGHTS, sizeof(*weights));
+        residuals = calloc((size_t)n_threads * OTHELLO_NUM_WEIGHTS,
+                           sizeof(*residuals));
+        counts = calloc((size_t)n_threads * OTHELLO_NUM_WEIGHTS,
+                        sizeof(*counts));
+        quantized = calloc(OTHELLO_NUM_WEIGHTS, sizeof(*quantized));
+        if (!weights || !residuals || !counts || !quantized) {
+                fprintf(stderr, "out of memory\n");
+                return 1;
+        }
+
+        printf("%ld positions, %d threads\n", records, n_threads);
+
+        for (it = 0; it < iterations; it++) {
+                for (t = 0; t < n_threads; t++) {
+                        threads[t].path = argv[optind];
+                        threads[t].first = records * t / n_threads;
+                        threads[t].end = records * (t + 1) / n_threads;
+                        threads[t].weights = weights;
+                        threads[t].residuals = residuals +
+                                               (size_t)t * OTHELLO_NUM_WEIGHTS;
+                        threads[t].counts = it == 0 ? counts +
+                                (size_t)t * OTHELLO_NUM_WEIGHTS : NULL;
+                        if (pthread_create(&threads[t].thread, NULL,
+                                           fit_thread, &threads[t]) != 0) {
+                                fprintf(stderr, "pthread_create failed\n");
+                                return 1;
+                        }
+                }
+
+                error = 0;
+                for (t = 0; t < n_threads; t++) {
+                        pthread_join(threads[t].thread, NULL);
+                        error += threads[t].squared_error;
+                }
+
+                /* Sum the threads' results into those of the first. */
+                for (t = 1; t < n_threads; t++) {
+                        for (i = 0; i < OTHELLO_NUM_WEIGHTS; i++) {
+                                residuals[i] += threads[t].residuals[i];
+                                if (it == 0) {
+                                        counts[i] += counts[(size_t)t *
+                                                OTHELLO_NUM_WEIGHTS + i];
+                                }
+                        }
+                }
+
+                for (i = 0; i < OTHELLO_NUM_WEIGHTS; i++) {
+                        weights[i] += (float)(rate * residuals[i] /
+                                              (counts[i] + SMOOTHING));
+                }
+
+                printf("iteration %d: rms error %.2f disks\n", it + 1,
+                       sqrt(error / records) / DISK_SCALE);
+                fflush(stdout);
+        }
+
+        for (i = 0; i < OTHELLO_NUM_WEIGHTS; i++) {
+                quantized[i] = (int16_t)(weights[i] > INT16_MAX ? INT16_MAX :
+                                         weights[i] < -INT16_MAX ? -INT16_MAX :
+                                         lrintf(weights[i]));
+        }
+        if (!othello_save_weights(argv[optind + 1], quantized)) {
+                perror(argv[optind + 1]);
+                return 1;
+        }
+
+        free(weights);
+        free(residuals);
+        free(counts);
+        free(quantized);
+
+        return 0;
+}
+
+/* Network fitting: stochastic gradient descent on a floating-point copy of
+   the network, one position at a time, which is then quantised. Its output
+   is in units of 64 disks, to keep it in the range of the activations. */
+
+#define NET_OUTPUT_DISKS 64
+
+typedef struct {
+        float w1[OTHELLO_NET_INPUTS][OTHELLO_NET_HIDDEN1];
+        float b1[OTHELLO_NET_HIDDEN1];
+        float w2[OTHELLO_NET_HIDDEN2][OTHELLO_NET_HIDDEN1];
+        float b2[OTHELLO_NET_HIDDEN2];
+        float w3[OTHELLO_NET_HIDDEN2];
+        float b3;
+} float_network_t;
+
+static float random_float(float range)
+{
+        return range * (2.0f * (float)rand() / (float)RAND_MAX - 1.0f);
+}
+
+static float clamp01(float x)
+{
+        return x < 0 ? 0 : x > 1 ? 1 : x;
+}
+
+/* Take one gradient step towards the position's score. Returns the error
+   before the step. */
+static float train_position(float_network_t *net, const position_t *pos,
+                            float rate)
+{
+        float z1[OTHELLO_NET_HIDDEN1], h1[OTHELLO_NET_HIDDEN1];
+        float z2[OTHELLO_NET_HIDDEN2], h2[OTHELLO_NET_HIDDEN2];
+        float d1[OTHELLO_NET_HIDDEN1], d2[OTHELLO_NET_HIDDEN2];
+        int inputs[64], n_inputs = 0;
+        float y, e;
+        int i, j, k;
+
+        for (i = 0; i < 64; i++) {
+                if (pos->o.disks[0] >> i & 1) {
+                        inputs[n_inputs++] = i;
+                } else if (pos->o.disks[1] >> i & 1) {
+                        inputs[n_inputs++] = 64 + i;
+                }
+        }
+
+        for (j = 0; j < OTHELLO_NET_HIDDEN1; j++) {
+                z1[j] = net->b1[j];
+                for (i = 0; i < n_inputs; i++) {
+                        z1[j] += net->w1[inputs[i]][j];
+                }
+                h1[j] = clamp01(z1[j]);
+        }
+        y = net->b3;
+        for (k = 0; k < OTHELLO_NET_HIDDEN2; k++) {
+                z2[k] = net->b2[k];
+                for (j = 0; j < OTHELLO_NET_HIDDEN1; j++) {
+                        z2[k] += net->w2[k][j] * h1[j];
+                }
+                h2[k] = clamp01(z2[k]);
+                y += net->w3[k] * h2[k];
+        }
+
+        e = y - (float)pos->score / NET_OUTPUT_DISKS;
+
+        for (j = 0; j < OTHELLO_NET_HIDDEN1; j++) {
+                d1[j] = 0;
+        }
+        for (k = 0; k < OTHELLO_NET_HIDDEN2; k++) {
+                d2[k] = z2[k] > 0 && z2[k] < 1 ? e * net->w3[k] : 0;
+                net->w3[k] -= rate * e * h2[k];
+                if (d2[k] == 0) {
+                        continue;
+                }
+                for (j = 0; j < OTHELLO_NET_HIDDEN1; j++) {
+                        d1[j] += d2[k] * net->w2[k][j];
+                        net->w2[k][j] -= rate * d2[k] * h1[j];
+                }
+                net->b2[k] -= rate * d2[k];
+        }
+        net->b3 -= rate * e;
+
+        for (j = 0; j < OTHELLO_NET_HIDDEN1; j++) {
+                if (z1[j] <= 0 || z1[j] >= 1) {
+                        continue;
+                }
+                for (i = 0; i < n_inputs; i++) {
+                        net->w1[inputs[i]][j] -= rate * d1[j];
+                }
+                net->b1[j] -= rate * d1[j];
+        }
+
+        return e;
+}
+
+static int16_t quantize16(float x)
+{
+        long q = lrintf(x);
+
+        return (int16_t)(q > INT16_MAX ? INT16_MAX :
+                         q < -INT16_MAX ? -INT16_MAX : q);
+}
+
+static void quantize_network(const float_network_t *f, othello_network_t *q)
+{
+        const float one = OTHELLO_NET_ONE;
+        int i, j, k;
+
+        for (i = 0; i < OTHELLO_NET_INPUTS; i++) {
+                for (j = 0; j < OTHELLO_NET_HIDDEN1; j++) {
+                        q->w1[i][j] = quantize16(f->w1[i][j] * one);
+                }
+        }
+        for (j = 0; j < OTHELLO_NET_HIDDEN1; j++) {
+                q->b1[j] = quantize16(f->b1[j] * one);
+        }
+        for (k = 0; k < OTHELLO_NET_HIDDEN2; k++) {
+                for (j = 0; j < OTHELLO_NET_HIDDEN1; j++) {
+                        q->w2[k][j] = quantize16(f->w2[k][j] * one);
+                }
+                q->b2[k] = (int32_t)lrintf(f->b2[k] * one * one);
+                q->w3[k] = quantize16(f->w3[k] * NET_OUTPUT_DISKS *
+                                      DISK_SCALE);
+        }
+        q->b3 = (int32_t)lrintf(f->b3 * NET_OUTPUT_DISKS * DISK_SCALE * one);
+}
+
+static int fit_network(int argc, char **argv)
+{
+        int iterations = 10;
+        double rate = 0.01, error;
+        float_network_t *net;
+        othello_network_t *quantized;
+        unsigned char *buf;
+        position_t pos;
+        long records, i, n;
+        int c, it, j, k, order[CHUNK_RECORDS], tmp;
+        FILE *f;
+
+        while ((c = getopt(argc, argv, "i:l:")) != -1) {
+                switch (c) {
+                case 'i': iterations = parse_int(optarg, 1); break;
+                case 'l': rate = atof(optarg); break;
+                default: usage();
+                }
+        }
+        if (optind != argc - 2 || rate <= 0) {
+                usage();
+        }
+
+        f = fopen(argv[optind], "rb");
+        if (f == NULL || fseek(f, 0, SEEK_END) != 0 ||
+            (records = ftell(f) / RECORD_SIZE) <= 0) {
+                fprintf(stderr, "%s: no positions\n", argv[optind]);
+                return 1;
+        }
+
+        net = calloc(1, sizeof(*net));
+        quantized = calloc(1, sizeof(*quantized));
+        buf = malloc((size_t)CHUNK_RECORDS * RECORD_SIZE);
+        if (!net || !quantized || !buf) {
+                fprintf(stderr, "out of memory\n");
+                return 1;
+        }
+
+        srand(1);
+        for (i = 0; i < OTHELLO_NET_INPUTS; i++) {
+                for (j = 0; j < OTHELLO_NET_HIDDEN1; j++) {
+                        net->w1[i][j] = random_float(0.1f);
+                }
+        }
+        for (j = 0; j < OTHELLO_NET_HIDDEN1; j++) {
+                net->b1[j] = 0.5f;
+        }
+        for (k = 0; k < OTHELLO_NET_HIDDEN2; k++) {
+                for (j = 0; j < OTHELLO_NET_HIDDEN1; j++) {
+                        net->w2[k][j] = random_float(0.25f);
+                }
+                net->b2[k] = 0.5f;
+                net->w3[k] = random_float(1.0f);
+        }
+
+        printf("%ld positions\n", records);
+
+        for (it = 0; it < iterations; it++) {
+                rewind(f);
+                error = 0;
+                for (i = 0; i < records; i += n) {
+                        n = records - i < CHUNK_RECORDS ? records - i :
+                                                          CHUNK_RECORDS;
+                        if (fread(buf, RECORD_SIZE, (size_t)n, f) !=
+                            (size_t)n) {
+                                fprintf(stderr, "%s: read error\n",
+                                        argv[optind]);
+                                return 1;
+                        }
+
+                        /* The positions of a game are together in the file,
+                           so visit each chunk in random order. */
+                        for (j = 0; j < n; j++) {
+                                order[j] = j;
+                        }
+                        for (j = (int)n - 1; j > 0; j--) {
+                                k = rand() % (j + 1);
+                                tmp = order[j];
+                                order[j] = order[k];
+                                order[k] = tmp;
+                        }
+
+                        for (j = 0; j < n; j++) {
+                                decode_position(&buf[order[j] * RECORD_SIZE],
+                                                &pos);
+                                error += pow(train_position(net, &pos,
+                                                            (float)rate), 2);
+                        }
+                }
+
+                printf("iteration %d: rms error %.2f disks\n", it + 1,
+                       sqrt(error / records) * NET_OUTPUT_DISKS);
+                fflush(stdout);
+        }
+        fclose(f);
+
+        quantize_network(net, quantized);
+        if (!othello_save_network(argv[optind + 1], quantized)) {
+                perror(argv[optind + 1]);
+                return 1;
+        }
+
+        free(net);
+        free(quantized);
+        free(buf);
+
+        return 0;
+}
+
+/* Multi-ProbCut calibration. Each sample is searched to increasing depths
+   until the maximum, or until the game's end is reached, and for each phase
+   and depth, the scores are fitted against those at the shallow depth by
+   least squares. */
+
+#define PROBCUT_MIN_DEPTH 3
+#define PROBCUT_MIN_SAMPLES 20  /* Fewer can't give a reliable fit. */
+#define PROBCUT_FEATURES (OTHELLO_SEARCH_HASH | OTHELLO_SEARCH_ORDERING | \
+                          OTHELLO_SEARCH_PVS | OTHELLO_SEARCH_INCREMENTAL)
+
+typedef struct {
+        int phase;
+        int depths;             /* Scores are known to this depth. */
+        int scores[OTHELLO_PROBCUT_MAX_DEPTH + 1];
+} probcut_sample_t;
+
+/* The depth of the shallow search for a deep one. */
+static int probcut_shallow_depth(int depth)
+{
+        return depth / 2;
+}
+
+static void fit_probcut(const probcut_sample_t *samples, int n, int phase,
+                        int depth, othello_probcut_t *pc)
+{
+        double sx = 0, sy = 0, sxx = 0, sxy = 0, r, ss = 0;
+        int i, x, y, count = 0;
+        int shallow = probcut_shallow_depth(depth);
+
+        for (i = 0; i < n; i++) {
+                if (samples[i].phase == phase && samples[i].depths >= depth) {
+                        x = samples[i].scores[shallow];
+                        y = samples[i].scores[depth];
+                        sx += x;
+                        sy += y;
+                        sxx += (double)x * x;
+                        sxy += (double)x * y;
+                        count++;
+                }
+        }
+
+        memset(pc, 0, sizeof(*pc));
+        if (count < PROBCUT_MIN_SAMPLES ||
+            count * sxx - sx * sx <= 0) {
+                return;
+        }
+
+        pc->a = (float)((count * sxy - sx * sy) / (count * sxx - sx * sx));
+        pc->b = (float)((sy - pc->a * sx) / count);
+        for (i = 0; i < n; i++) {
+                if (samples[i].phase == phase && samples[i].depths >= depth) {
+                        r = samples[i].scores[depth] - pc->a *
+                            samples[i].scores[shallow] - pc->b;
+                        ss += r * r;
+                }
+        }
+        pc->sigma = (float)sqrt(ss / count);
+        if (pc->a > 0) {
+                pc->depth = shallow;
+        }
+}
+
+static int probcut(int argc, char **argv)
+{
+        othello_probcut_t pc;
+        othello_search_info_t info;
+        probcut_sample_t *samples;
+        unsigned char buf[RECORD_SIZE];
+        position_t pos;
+        int n_samples = 2000, max_depth = 12;
+        long records, i;
+        int c, n, d, phase;
+        FILE *f;
+
+        while ((c = getopt(argc, argv, "n:d:w:m:")) != -1) {
+                switch (c) {
+                case 'n': n_samples = parse_int(optarg, 1); break;
+                case 'd': max_depth = parse_int(optarg, 1); break;
+                case 'w':
+                        if (!othello_load_weights(optarg)) {
+                                fprintf(stderr, "invalid weight file: %s\n",
+                                        optarg);
+                                return 1;
+                        }
+                        break;
+                case 'm':
+                        if (!othello_load_network(optarg)) {
+                                fprintf(stderr, "invalid network file: %s\n",
+                                        optarg);
+                                return 1;
+                        }
+                        break;
+                default: usage();
+                }
+        }
+        if (optind != argc - 1 || max_depth > OTHELLO_PROBCUT_MAX_DEPTH) {
+                usage();
+        }
+
+        f = fopen(argv[optind], "rb");
+        if (f == NULL || fseek(f, 0, SEEK_END) != 0 ||
+            (records = ftell(f) / RECORD_SIZE) <= 0) {
+                fprintf(stderr, "%s: no positions\n", argv[optind]);
+                return 1;
+        }
+        n_samples = records < n_samples ? (int)records : n_samples;
+
+        samples = calloc((size_t)n_samples, sizeof(*samples));
+        if (samples == NULL) {
+                fprintf(stderr, "out of memory\n");
+                return 1;
+        }
+
+        for (n = 0; n < n_samples; n++) {
+                i = records * n / n_samples;
+                if (fseek(f, i * RECORD_SIZE, SEEK_SET) != 0 ||
+                    fread(buf, RECORD_SIZE, 1, f) != 1) {
+                        fprintf(stderr, "%s: read error\n", argv[optind]);
+                        return 1;
+                }
+                decode_position(buf, &pos);
+                if (!othello_has_valid_move(&pos.o, PLAYER_BLACK)) {
+                        continue;
+                }
+
+                samples[n].phase = (empty_cells(&pos.o) - 1) / 10;
+                othello_clear_hash();
+                for (d = 1; d <= max_depth; d++) {
+                        samples[n].scores[d] = othello_negamax_stats(
+                                &pos.o, PLAYER_BLACK, d, PROBCUT_FEATURES,
+                                &info);
+                        if (info.exact) {
+                                break;
+                        }
+                        samples[n].depths = d;
+                }
+
+                if ((n + 1) % 100 == 0 || n + 1 == n_samples) {
+                        fprintf(stderr, "%d positions\n", n + 1);
+                }
+        }
+        fclose(f);
+
+        printf("static const othello_probcut_t\n"
+               "builtin_probcut[OTHELLO_PROBCUT_PHASES]"
+               "[OTHELLO_PROBCUT_MAX_DEPTH + 1] = {\n");
+        for (phase = 0; phase < OTHELLO_PROBCUT_PHASES; phase++) {
+                printf("        { /* %d-%d empty cells. */\n", phase * 10 + 1,
+                       phase * 10 + 10);
+                for (d = 0; d <= OTHELLO_PROBCUT_MAX_DEPTH; d++) {
+                        memset(&pc, 0, sizeof(pc));
+                        if (d >= PROBCUT_MIN_DEPTH && d <= max_depth) {
+                                fit_probcut(samples, n_samples, phase, d, &pc);
+                        }
+                        printf("%16s{ %d, %.3ff, %.3ff, %.3ff }%s\n", "",
+                               pc.depth, pc.a, pc.b, pc.sigma,
+                               d < OTHELLO_PROBCUT_MAX_DEPTH ? "," : "");
+                }
+                printf("        }%s\n",
+                       phase < OTHELLO_PROBCUT_PHASES - 1 ? "," : "");
+        }
+        printf("};\n");
+
+        free(samples);
+
+        return 0;
+}
+
+int main(int argc, char **argv)
+{
+        if (argc < 2) {
+                usage();
+        }
+
+        if (!strcmp(argv[1], "generate")) {
+                return generate(argc - 1, argv + 1);
+        }
+        if (!strcmp(argv[1], "fit")) {
+                return fit(argc - 1, argv + 1);
+        }
+        if (!strcmp(argv[1], "fit-network")) {
+                return fit_network(argc - 1, argv + 1);
+        }
+        if (!strcmp(argv[1], "probcut")) {
+                return probcut(argc - 1, argv + 1);
+        }
+
+        usage();
+        return 1;
+}
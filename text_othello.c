@@ -36,6 +36,47 @@ static void print_move(int row, int col)
         printf("%c%d", "abcdefgh"[col], row + 1);
 }
 
+static int move_time;  /* Milliseconds per move, or 0 for a fixed search. */
+static bool verbose;   /* Print search information. */
+static othello_search_info_t info;
+static bool have_info; /* info is for the last move. */
+
+static void compute_move(const othello_t *o, player_t p, int *row, int *col)
+{
+        othello_stop_pondering();
+        if (move_time > 0) {
+                othello_compute_move_timed(o, p, move_time, OTHELLO_SEARCH_ALL,
+                                           row, col, &info);
+        } else {
+                othello_compute_move_stats(o, p, OTHELLO_SEARCH_ALL, row, col,
+                                           &info);
+        }
+        have_info = true;
+}
+
+static void print_info(void)
+{
+        int i;
+
+        if (!verbose || !have_info) {
+                return;
+        }
+        have_info = false;
+
+        printf("\n  depth %d/%d, score %+d%s, %llu nodes in %.2f s "
+               "(%.0f nodes/s), pv", info.depth, info.seldepth, info.score,
+               info.exact ? " (exact)" : "", (unsigned long long)info.nodes,
+               info.time, info.time > 0 ? info.nodes / info.time : 0.0);
+        for (i = 0; i < info.pv_length; i++) {
+                printf(" ");
+                if (info.pv[i] == -1) {
+                        printf("pass");
+                } else {
+                        print_move(info.pv[i] / 8, info.pv[i] % 8);
+                }
+        }
+}
+
 static void play(bool self_play)
 {
         othello_t o;
@@ -66,10 +107,11 @@ static void play(bool self_play)
                                         othello_compute_random_move(&o,
                                                         PLAYER_BLACK, &i, &j);
                                 } else {
-                                        othello_compute_move(&o,
-                                                        PLAYER_BLACK, &i, &j);
+                                        compute_move(&o, PLAYER_BLACK, &i,
+                                                     &j);
                                 }
                                 print_move(i, j);
+                                print_info();
                                 printf("\n");
                         } else {
                                 printf("Black's move: ");
@@ -94,12 +136,22 @@ static void play(bool self_play)
                                 othello_compute_random_move(&o,
                                                 PLAYER_WHITE, &i, &j);
                         } else {
-                                othello_compute_move(&o, PLAYER_WHITE, &i, &j);
+                                compute_move(&o, PLAYER_WHITE, &i, &j);
                         }
                         print_move(i, j);
+                        print_info();
                         printf("\n");
                         othello_make_move(&o, PLAYER_WHITE, i, j);
                         n++;
+
+                        if (!self_play) {
+                                /* Think on the expected reply while the
+                                   human thinks. */
+                                othello_start_pondering(&o, PLAYER_BLACK,
+                                                        info.pv_length > 1 ?
+                                                        info.pv[1] : -1,
+                                                        OTHELLO_SEARCH_ALL);
+                        }
                 }
 
                 printf("\n");
@@ -108,8 +160,45 @@ static void play(bool self_play)
 
 int main(int argc, char **argv)
 {
+        bool self_play = false;
+        int i;
+
+        for (i = 1; i < argc; i++) {
+                if (!strcmp(argv[i], "self")) {
+                        self_play = true;
+                } else if (!strcmp(argv[i], "-w") && i + 1 < argc) {
+                        if (!othello_load_weights(argv[++i])) {
+                                fprintf(stderr, "invalid weight file: %s\n",
+                                        argv[i]);
+                                return 1;
+                        }
+                } else if (!strcmp(argv[i], "-n") && i + 1 < argc) {
+                        if (!othello_load_network(argv[++i])) {
+                                fprintf(stderr, "invalid network file: %s\n",
+                                        argv[i]);
+                                return 1;
+                        }
+                } else if (!strcmp(argv[i], "-b") && i + 1 < argc) {
+                        if (!othello_load_book(argv[++i])) {
+                                fprintf(stderr, "invalid book file: %s\n",
+                                        argv[i]);
+                                return 1;
+                        }
+                } else if (!strcmp(argv[i], "-v")) {
+                        verbose = true;
+                } else if (!strcmp(argv[i], "-t") && i + 1 < argc &&
+                           atoi(argv[i + 1]) > 0) {
+                        move_time = atoi(argv[++i]);
+                } else {
+                        fprintf(stderr, "usage: %s [self] [-w weights] "
+                                "[-n network] [-b book] [-t ms] [-v]\n",
+                                argv[0]);
+                        return 1;
+                }
+        }
+
         while (true) {
-                play(argc == 2 && !strcmp(argv[1], "self"));
+                play(self_play);
         }
 
         return 0;
@@ -1,6 +1,7 @@
 #include <assert.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include <stdlib.h>
 
 #include <process.h>
 #include <windows.h>
@@ -10,6 +11,7 @@
 
 static othello_t board;
 static enum { BLACKS_MOVE, WHITES_MOVE, GAME_OVER } state;
+static unsigned game;           /* Incremented for each new game. */
 
 static struct {
         int x, y;       /* Position of the grid relative to window origin. */
@@ -24,6 +26,21 @@ static struct {
 #define INIT_SIZE 450    /* Initial window size. */
 #define WM_WHITE_MOVE (WM_USER + 0)
 
+/* A search for white's move, on its own thread. Pondering is only started
+   and stopped on the window's thread, so the search never touches it. */
+typedef struct {
+        HWND window;
+        othello_t board;
+        unsigned game;
+        othello_stop_t stop;    /* Set to abandon the search. */
+        int row, col;
+        int reply;              /* Black's expected reply, or -1. */
+} white_search_t;
+
+/* The search for the current game's move, or NULL. It is freed only after
+   its WM_WHITE_MOVE has been handled. */
+static white_search_t *white_search;
+
 static const char APP_NAME[] = "othello";
 static HBRUSH background_brush, board_brush, highlight_brush,
               white_brush, black_brush, valid_brush;
@@ -156,14 +173,36 @@ static void draw_grid(HDC dc)
         }
 }
 
-static void compute_white_move(void *window)
+static void compute_white_move(void *arg)
 {
-        int row, col;
+        white_search_t *ws = arg;
+        othello_search_info_t info;
+
+        othello_compute_move_stoppable(&ws->board, PLAYER_WHITE, 0,
+                                       OTHELLO_SEARCH_ALL, &ws->stop,
+                                       &ws->row, &ws->col, &info);
+        ws->reply = info.pv_length > 1 ? info.pv[1] : -1;
+
+        SendMessage(ws->window, WM_WHITE_MOVE, 0, (LPARAM)ws);
+        free(ws);
+}
+
+static void start_white_search(HWND window)
+{
+        white_search_t *ws;
 
-        assert(state == WHITES_MOVE);
+        othello_stop_pondering();
 
-        othello_compute_move(&board, PLAYER_WHITE, &row, &col);
-        SendMessage((HWND)window, WM_WHITE_MOVE, row, col);
+        ws = malloc(sizeof(*ws));
+        if (ws == NULL) {
+                err("malloc failed!");
+        }
+        ws->window = window;
+        ws->board = board;
+        ws->game = game;
+        ws->stop = 0;
+        white_search = ws;
+        _beginthread(compute_white_move, 0, ws);
 }
 
 /* Make a move for the current player and transition the game state. */
@@ -196,7 +235,7 @@ static void make_move(HWND window, int row, int col)
         }
 
         if (state == WHITES_MOVE) {
-                _beginthread(compute_white_move, 0, (void*)window);
+                start_white_search(window);
         }
 
         InvalidateRect(window, NULL, TRUE);
@@ -204,6 +243,13 @@ static void make_move(HWND window, int row, int col)
 
 static void new_game(void)
 {
+        game++;
+        if (white_search != NULL) {
+                /* Its move is ignored. */
+                white_search->stop = 1;
+                white_search = NULL;
+        }
+        othello_stop_pondering();
         othello_init(&board);
         state = BLACKS_MOVE;
 }
@@ -298,6 +344,7 @@ static LRESULT CALLBACK wnd_proc(HWND window, UINT message, WPARAM wparam,
 {
         HDC dc;
         PAINTSTRUCT ps;
+        const white_search_t *ws;
         int row, col;
 
         switch (message) {
@@ -359,9 +406,22 @@ static LRESULT CALLBACK wnd_proc(HWND window, UINT message, WPARAM wparam,
                 break;
 
         case WM_WHITE_MOVE:
-                /* White computed a move. */
+                /* White computed a move; ignore it if a new game started
+                   meanwhile. */
+                ws = (const white_search_t *)lparam;
+                if (ws->game != game) {
+                        return 0;
+                }
+                white_search = NULL;
                 assert(state == WHITES_MOVE);
-                make_move(window, wparam, lparam);
+                make_move(window, ws->row, ws->col);
+                if (state == BLACKS_MOVE) {
+                        /* Think on the expected reply while the human
+                           thinks. */
+                        othello_start_pondering(&board, PLAYER_BLACK,
+                                                ws->reply,
+                                                OTHELLO_SEARCH_ALL);
+                }
                 return 0;
 
         case WM_DESTROY:
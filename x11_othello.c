@@ -1,5 +1,6 @@
 #include <assert.h>
 #include <errno.h>
+#include <pthread.h>
 #include <stdarg.h>
 #include <stdbool.h>
 #include <stdint.h>
@@ -313,31 +314,127 @@ static void draw_grid(void)
         }
 }
 
+/* White's moves are searched by a thread that lives as long as the
+   program, so the hash tables stay warm from one move to the next, and
+   that ponders while the human thinks. It is sent commands through a
+   queue, and sends the moves back through a pipe, which wakes up the event
+   loop. */
+
+typedef enum { CMD_SEARCH, CMD_NEW_GAME, CMD_QUIT } command_type_t;
+
+typedef struct {
+        command_type_t type;
+        othello_t board;
+        unsigned game;          /* The game the search is for. */
+} command_t;
+
+typedef struct {
+        unsigned game;
+        int move;               /* As row * 8 + col. */
+} reply_t;
+
+#define QUEUE_SIZE 8
+
+static command_t queue[QUEUE_SIZE]; /* Commands not yet taken, as a ring. */
+static int queue_head;
+static int queue_count;
+static unsigned game;           /* Incremented for each new game. */
+static pthread_mutex_t queue_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t queue_cond = PTHREAD_COND_INITIALIZER;
+static othello_stop_t stop_search; /* Set to abandon the current search. */
+static pthread_t engine_thread;
 static int white_move_pipe[2]; /* [0] for reading, [1] for writing. */
 
-static void compute_white_move(void)
+static void *engine(void *arg)
 {
-        int x, row, col;
-        char c;
+        othello_engine_config_t config;
+        othello_search_info_t info;
+        othello_engine_t *e;
+        command_t cmd;
+        reply_t reply;
+        int row, col;
 
-        assert(state == WHITES_MOVE);
+        (void)arg;
 
-        /* Compute white's move in a background process. */
-        if ((x = fork()) == -1) {
-                err("fork() failed: %s", strerror(errno));
-        } else if (x != 0) {
-                /* Parent process. */
-                return;
+        othello_engine_default_config(&config);
+        if ((e = othello_engine_create(&config)) == NULL) {
+                err("othello_engine_create() failed");
         }
 
-        /* Child process: compute the move and send it through the pipe. */
-        othello_compute_move(&board, PLAYER_WHITE, &row, &col);
-        c = (char)(row * 8 + col);
-        if (write(white_move_pipe[1], &c, 1) != 1) {
-                err("write() failed");
+        for (;;) {
+                pthread_mutex_lock(&queue_mutex);
+                while (queue_count == 0) {
+                        pthread_cond_wait(&queue_cond, &queue_mutex);
+                }
+                cmd = queue[queue_head];
+                queue_head = (queue_head + 1) % QUEUE_SIZE;
+                queue_count--;
+                stop_search = 0;
+                pthread_mutex_unlock(&queue_mutex);
+
+                othello_engine_stop_pondering(e);
+                if (cmd.type == CMD_QUIT) {
+                        break;
+                } else if (cmd.type == CMD_NEW_GAME) {
+                        continue;
+                }
+
+                othello_engine_compute_move(e, &cmd.board, PLAYER_WHITE, 0,
+                                            &stop_search, &row, &col, &info);
+                reply.game = cmd.game;
+                reply.move = row * 8 + col;
+                if (write(white_move_pipe[1], &reply, sizeof(reply)) !=
+                    sizeof(reply)) {
+                        err("write() failed");
+                }
+
+                /* Think on the expected reply while the human thinks. */
+                othello_make_move(&cmd.board, PLAYER_WHITE, row, col);
+                othello_engine_start_pondering(e, &cmd.board, PLAYER_BLACK,
+                                               info.pv_length > 1 ?
+                                               info.pv[1] : -1);
+        }
+        othello_engine_destroy(e);
+
+        return NULL;
+}
+
+/* Add a command to the engine's queue. */
+static void send_command(command_type_t type)
+{
+        command_t *cmd;
+
+        pthread_mutex_lock(&queue_mutex);
+        if (queue_count == QUEUE_SIZE) {
+                /* The engine is that far behind, so the oldest command has
+                   been overtaken by the rest; drop it. */
+                queue_head = (queue_head + 1) % QUEUE_SIZE;
+                queue_count--;
         }
+        cmd = &queue[(queue_head + queue_count) % QUEUE_SIZE];
+        cmd->type = type;
+        cmd->board = board;
+        cmd->game = game;
+        queue_count++;
+        pthread_cond_signal(&queue_cond);
+        pthread_mutex_unlock(&queue_mutex);
+}
+
+/* Abandon any search for the current game; its move is ignored. */
+static void abandon_search(void)
+{
+        pthread_mutex_lock(&queue_mutex);
+        game++;
+        stop_search = 1;
+        queue_count = 0;        /* Commands not yet taken are for it too. */
+        pthread_mutex_unlock(&queue_mutex);
+}
+
+static void compute_white_move(void)
+{
+        assert(state == WHITES_MOVE);
 
-        exit(EXIT_SUCCESS);
+        send_command(CMD_SEARCH);
 }
 
 /* Make a move for the current player and transition the game state. */
@@ -376,8 +473,10 @@ static void make_move(int row, int col)
 
 static void new_game(void)
 {
+        abandon_search();
         othello_init(&board);
         state = BLACKS_MOVE;
+        send_command(CMD_NEW_GAME);
 }
 
 static void on_mouse_click(void)
@@ -447,6 +546,10 @@ static void on_key_press(XKeyEvent *xkey, bool *quit, bool *draw)
         case XK_q:
                 *quit = true;
                 return;
+        case XK_n:
+                new_game();
+                *draw = true;
+                return;
         case XK_space:
         case XK_Return:
                 on_mouse_click();
@@ -483,7 +586,7 @@ static void event_loop(void)
         bool quit, draw;
         fd_set fds;
         XEvent event;
-        char c;
+        reply_t reply;
 
         display_fd = XConnectionNumber(display);
         quit = false;
@@ -507,11 +610,16 @@ static void event_loop(void)
 
                         if (FD_ISSET(white_move_pipe[0], &fds)) {
                                 /* Read white move from the pipe. */
-                                if (read(white_move_pipe[0], &c, 1) != 1) {
+                                if (read(white_move_pipe[0], &reply,
+                                         sizeof(reply)) != sizeof(reply)) {
                                         err("read() failed");
                                 }
-                                make_move(c / 8, c % 8);
-                                draw = true;
+                                if (reply.game == game &&
+                                    state == WHITES_MOVE) {
+                                        make_move(reply.move / 8,
+                                                  reply.move % 8);
+                                        draw = true;
+                                }
                                 continue;
                         }
                 }
@@ -556,6 +664,9 @@ int main(int argc, char **argv)
         if (pipe(white_move_pipe) != 0) {
                 err("pipe() failed: %s\n", strerror(errno));
         }
+        if (pthread_create(&engine_thread, NULL, engine, NULL) != 0) {
+                err("pthread_create() failed");
+        }
 
         grid.sel_row = -1;
         init(argc, argv);
@@ -563,6 +674,10 @@ int main(int argc, char **argv)
 
         event_loop();
 
+        abandon_search();
+        send_command(CMD_QUIT);
+        pthread_join(engine_thread, NULL);
+
         XFreeGC(display, black_gc);
         XFreeGC(display, white_gc);
         XFreeGC(display, board_gc);